@@ -0,0 +1,42 @@
+/**
+ * @file node churn benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "churn.hpp"
+#include "perf.hpp"
+#include "picobench/picobench.hpp"
+#include <vector>
+
+using picobench::state;
+
+PICOBENCH_SUITE("churn");
+
+/**
+ * Deletes and reinserts a child of nodes holding capacity + 1 children.
+ */
+template <class Shrink>
+static void art_churn(state &s, int capacity, const char *benchmark) {
+  key_set keys(churn::keys(capacity));
+  std::vector<uint32_t> steps = churn::steps(s.iterations(), capacity);
+  int v = 1;
+  art::art<int *, art::no_counters, Shrink> m;
+  churn::fill(m, keys, &v);
+  for (auto i : perf::measure(s, benchmark)) {
+    churn::step(m, keys, steps[i], &v);
+  }
+}
+
+#define CHURN_BENCH(policy, capacity)                                          \
+  static void art_churn_##policy##_##capacity(state &s) {                      \
+    art_churn<art::policy##_shrink>(s, capacity, __func__);                    \
+  }                                                                            \
+  PICOBENCH(art_churn_##policy##_##capacity).iterations({100000})
+
+CHURN_BENCH(eager, 4);
+CHURN_BENCH(hysteresis, 4);
+CHURN_BENCH(eager, 16);
+CHURN_BENCH(hysteresis, 16);
+CHURN_BENCH(eager, 48);
+CHURN_BENCH(hysteresis, 48);
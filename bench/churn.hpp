@@ -0,0 +1,66 @@
+/**
+ * @file node churn workload for the benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef BENCH_CHURN_HPP
+#define BENCH_CHURN_HPP
+
+#include "dataset.hpp"
+#include "key_set.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+
+/**
+ * Inner nodes whose number of children oscillates around the capacity of a
+ * node type: every group holds capacity + 1 children and a step deletes one
+ * of them and inserts it again, i.e., the group's node drops to capacity
+ * children and grows back.
+ */
+namespace churn {
+
+/* number of groups, i.e., churned inner nodes */
+static const uint32_t n_groups = 10000;
+
+/**
+ * Child c of group g is the key at index g * (capacity + 1) + c.
+ */
+inline std::vector<std::string> keys(int capacity) {
+  std::vector<std::string> keys;
+  for (uint32_t g = 0; g < n_groups; ++g) {
+    for (int c = 0; c <= capacity; ++c) {
+      keys.push_back(dataset::encode_integer(g) + static_cast<char>('!' + c));
+    }
+  }
+  return keys;
+}
+
+template <class Tree, class V> void fill(Tree &m, const key_set &keys, V v) {
+  for (size_t i = 0; i < keys.size(); ++i) {
+    m.set(keys[i], v);
+  }
+}
+
+/**
+ * Indexes of the children deleted and reinserted by n steps, uniform over
+ * groups and children.
+ */
+inline std::vector<uint32_t> steps(size_t n, int capacity) {
+  std::mt19937_64 rng(0);
+  std::vector<uint32_t> children(n);
+  for (uint32_t &child : children) {
+    child = rng() % (n_groups * (capacity + 1));
+  }
+  return children;
+}
+
+template <class Tree, class V>
+void step(Tree &m, const key_set &keys, uint32_t child, V v) {
+  m.del(keys[child]);
+  m.set(keys[child], v);
+}
+
+} // namespace churn
+
+#endif
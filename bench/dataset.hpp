@@ -0,0 +1,242 @@
+/**
+ * @file key dataset generators for the benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef BENCH_DATASET_HPP
+#define BENCH_DATASET_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Deterministic generators of distinct keys with different shapes, the same
+ * seed always yields the same keys in the same order.
+ */
+namespace dataset {
+
+using std::string;
+using std::vector;
+
+/**
+ * Big-endian encoding of a 64-bit integer without null bytes: ten groups of
+ * 7 bits, most significant first, each stored as 0x80 | group. The encoding
+ * preserves the integer order both for signed and unsigned char comparison.
+ */
+inline string encode_integer(uint64_t value) {
+  string key(10, '\0');
+  for (int i = 9; i >= 0; --i, value >>= 7) {
+    key[i] = static_cast<char>(0x80 | (value & 0x7f));
+  }
+  return key;
+}
+
+inline uint64_t decode_integer(const string &key) {
+  uint64_t value = 0;
+  for (char c : key) {
+    value = (value << 7) | (static_cast<unsigned char>(c) & 0x7f);
+  }
+  return value;
+}
+
+/**
+ * Calls next until n distinct keys are generated.
+ */
+inline vector<string> distinct(size_t n, std::function<string()> next) {
+  vector<string> keys;
+  std::unordered_set<string> seen;
+  keys.reserve(n);
+  while (keys.size() < n) {
+    string key = next();
+    if (seen.insert(key).second) {
+      keys.push_back(std::move(key));
+    }
+  }
+  return keys;
+}
+
+/**
+ * The integers base, base + 1, ..., base + n - 1 in random order.
+ */
+inline vector<string> dense_integers(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  uint64_t base = rng() >> 16;
+  vector<string> keys;
+  keys.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back(encode_integer(base + i));
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  return keys;
+}
+
+/**
+ * Uniformly distributed 64-bit integers.
+ */
+inline vector<string> sparse_integers(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  return distinct(n, [&rng]() { return encode_integer(rng()); });
+}
+
+/**
+ * Picks a word, words at the front of the list are more likely.
+ */
+template <size_t N>
+inline const char *pick(std::mt19937_64 &rng, const char *const (&list)[N]) {
+  size_t a = rng() % N, b = rng() % N;
+  return list[std::min(a, b)];
+}
+
+static const char *const domains[] = {
+    "example", "github",  "wikipedia", "google",        "amazon", "reddit",
+    "youtube", "nytimes", "bbc",       "stackoverflow", "medium", "linkedin",
+    "netflix", "spotify", "apple",     "microsoft"};
+
+static const char *const words[] = {
+    "news",    "blog",     "product", "user",    "docs",     "search",
+    "images",  "video",    "article", "archive", "category", "help",
+    "account", "settings", "shop",    "cart",    "item",     "review",
+    "forum",   "thread",   "post",    "comment", "tag",      "about"};
+
+static const char *const first_names[] = {
+    "james",   "mary",    "john",   "patricia", "robert",
+    "jennifer", "michael", "linda",  "david",    "elizabeth",
+    "william", "barbara", "richard", "susan",    "joseph",
+    "jessica", "thomas",  "sarah",  "charles",  "karen"};
+
+static const char *const last_names[] = {
+    "smith",    "johnson", "williams", "brown",     "jones",  "garcia",
+    "miller",   "davis",   "rodriguez", "martinez", "hernandez", "lopez",
+    "gonzalez", "wilson",  "anderson", "thomas",    "taylor", "moore"};
+
+static const char *const email_domains[] = {
+    "gmail.com",  "yahoo.com",   "outlook.com", "hotmail.com",
+    "icloud.com", "example.org", "company.com", "university.edu"};
+
+/**
+ * URLs like https://www.github.com/docs/search/item?id=42, with long shared
+ * prefixes.
+ */
+inline vector<string> urls(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  return distinct(n, [&rng]() {
+    string url = "https://www.";
+    url += pick(rng, domains);
+    url += ".com";
+    for (int depth = 1 + rng() % 4; depth > 0; --depth) {
+      url += '/';
+      url += pick(rng, words);
+    }
+    url += "?id=" + std::to_string(rng() % 1000000);
+    return url;
+  });
+}
+
+/**
+ * Email addresses like mary.smith42@gmail.com.
+ */
+inline vector<string> emails(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  return distinct(n, [&rng]() {
+    string email = pick(rng, first_names);
+    email += '.';
+    email += pick(rng, last_names);
+    email += std::to_string(rng() % 10000);
+    email += '@';
+    email += pick(rng, email_domains);
+    return email;
+  });
+}
+
+/**
+ * Random (version 4) UUIDs like 3b241101-e2bb-4255-8caf-4136c566a962, with
+ * no shared prefixes beyond chance.
+ */
+inline vector<string> uuids(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  return distinct(n, [&rng]() {
+    static const char hex[] = "0123456789abcdef";
+    uint64_t hi = rng(), lo = rng();
+    /* version 4, variant 10 */
+    hi = (hi & ~0xf000ull) | 0x4000ull;
+    lo = (lo & ~(3ull << 62)) | (2ull << 62);
+    string uuid;
+    for (int i = 0; i < 32; ++i) {
+      if (i == 8 || i == 12 || i == 16 || i == 20) {
+        uuid += '-';
+      }
+      uint64_t word = i < 16 ? hi : lo;
+      uuid += hex[(word >> (60 - 4 * (i % 16))) & 0xf];
+    }
+    return uuid;
+  });
+}
+
+/**
+ * Hierarchical paths like docs/user/archive/7, where the fan-out grows with
+ * the depth, as in file systems.
+ */
+inline vector<string> paths(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  const size_t n_words = sizeof(words) / sizeof(words[0]);
+  return distinct(n, [&rng, n_words]() {
+    string path;
+    int depth = 2 + rng() % 5;
+    for (int level = 0; level < depth; ++level) {
+      size_t fanout = std::min<size_t>(n_words, 2 << level);
+      path += words[rng() % fanout];
+      path += '/';
+    }
+    path += std::to_string(rng() % 1000);
+    return path;
+  });
+}
+
+/**
+ * Generates n keys of the named dataset, i.e., one of dense_integers,
+ * sparse_integers, urls, emails, uuids and paths.
+ */
+inline vector<string> generate(const string &name, size_t n, uint64_t seed) {
+  if (name == "dense_integers") {
+    return dense_integers(n, seed);
+  } else if (name == "sparse_integers") {
+    return sparse_integers(n, seed);
+  } else if (name == "urls") {
+    return urls(n, seed);
+  } else if (name == "emails") {
+    return emails(n, seed);
+  } else if (name == "uuids") {
+    return uuids(n, seed);
+  } else if (name == "paths") {
+    return paths(n, seed);
+  }
+  throw std::invalid_argument("unknown dataset: " + name);
+}
+
+/**
+ * Reads one key per line from the file, if it exists and is not empty, else
+ * generates n paths.
+ */
+inline vector<string> load_or_generate(const string &filename, size_t n,
+                                       uint64_t seed) {
+  vector<string> keys;
+  std::ifstream file(filename);
+  string line;
+  while (std::getline(file, line)) {
+    if (!line.empty()) {
+      keys.push_back(line);
+    }
+  }
+  return keys.empty() ? paths(n, seed) : keys;
+}
+
+} // namespace dataset
+
+#endif
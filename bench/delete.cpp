@@ -4,11 +4,14 @@
  */
 
 #include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include <map>
 #include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 using picobench::state;
 
@@ -17,13 +20,13 @@ PICOBENCH_SUITE("delete");
 static void art_delete_sparse(state &s) {
   art::art<int*> m;
   int v = 1;
-  std::mt19937_64 g1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.set(std::to_string(g1()).c_str(), &v);
+  std::mt19937_64 g(0);
+  key_set keys(s.iterations(), [&g]() { return std::to_string(g()); });
+  for (size_t i = 0; i < keys.size(); ++i) {
+    m.set(keys[i], &v);
   }
-  std::mt19937_64 g2(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.del(std::to_string(g2()).c_str());
+  for (auto i : perf::measure(s, __func__)) {
+    m.del(keys[i]);
   }
 }
 PICOBENCH(art_delete_sparse);
@@ -31,13 +34,15 @@ PICOBENCH(art_delete_sparse);
 static void red_black_delete_sparse(state &s) {
   std::map<std::string, int> m;
   int v = 1;
-  std::mt19937_64 g1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m[std::to_string(g1()).c_str()] = v;
+  std::mt19937_64 g(0);
+  std::vector<std::string> keys =
+      key_set(s.iterations(), [&g]() { return std::to_string(g()); })
+          .to_strings();
+  for (const std::string &key : keys) {
+    m[key] = v;
   }
-  std::mt19937_64 g2(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.erase(m.find(std::to_string(g2())));
+  for (auto i : perf::measure(s, __func__)) {
+    m.erase(m.find(keys[i]));
   }
 }
 PICOBENCH(red_black_delete_sparse);
@@ -45,13 +50,15 @@ PICOBENCH(red_black_delete_sparse);
 static void hashmap_delete_sparse(state &s) {
   std::unordered_map<std::string, int> m;
   int v = 1;
-  std::mt19937_64 g1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m[std::to_string(g1())] = v;
+  std::mt19937_64 g(0);
+  std::vector<std::string> keys =
+      key_set(s.iterations(), [&g]() { return std::to_string(g()); })
+          .to_strings();
+  for (const std::string &key : keys) {
+    m[key] = v;
   }
-  std::mt19937_64 g2(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.erase(m.find(std::to_string(g2())));
+  for (auto i : perf::measure(s, __func__)) {
+    m.erase(m.find(keys[i]));
   }
 }
 PICOBENCH(hashmap_delete_sparse);
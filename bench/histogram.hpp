@@ -0,0 +1,85 @@
+/**
+ * @file latency histogram for the benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef BENCH_HISTOGRAM_HPP
+#define BENCH_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * HDR-style histogram of latencies: values below 2 * S are counted exactly,
+ * larger values fall into S log-spaced buckets per power of two, i.e., with a
+ * relative error below 1 / S. Recording is O(1) and allocation free.
+ */
+class latency_histogram {
+public:
+  latency_histogram() : counts_(n_buckets, 0) {}
+
+  void record(uint64_t value) {
+    ++counts_[bucket_of(value)];
+    ++count_;
+    sum_ += value;
+    max_ = std::max(max_, value);
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+  double mean() const {
+    return count_ > 0 ? static_cast<double>(sum_) / count_ : 0;
+  }
+
+  /**
+   * Smallest value v such that at least the given percentage of the recorded
+   * values are <= v, rounded up to the end of v's bucket.
+   *
+   * @param percentile - In [0, 100].
+   */
+  uint64_t percentile(double percentile) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100 * count_ + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, count_));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < n_buckets; ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min(highest_value_of(i), max_);
+      }
+    }
+    return max_;
+  }
+
+private:
+  static const unsigned sub_bucket_bits = 5;
+  static const uint64_t S = 1 << sub_bucket_bits;
+  static const unsigned n_buckets = (64 - sub_bucket_bits + 1) * S;
+
+  static unsigned bucket_of(uint64_t value) {
+    if (value < 2 * S) {
+      return value;
+    }
+    unsigned shift = 63 - __builtin_clzll(value) - sub_bucket_bits;
+    return (shift + 1) * S + ((value >> shift) - S);
+  }
+
+  static uint64_t highest_value_of(unsigned bucket) {
+    if (bucket < 2 * S) {
+      return bucket;
+    }
+    unsigned shift = bucket / S - 1;
+    uint64_t sub_bucket = bucket % S + S;
+    return ((sub_bucket + 1) << shift) - 1;
+  }
+
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+#endif
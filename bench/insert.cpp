@@ -4,13 +4,14 @@
  */
 
 #include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
-#include <functional>
 #include <map>
 #include <random>
 #include <string>
 #include <unordered_map>
-#include <queue>
+#include <vector>
 
 using picobench::state;
 
@@ -20,8 +21,9 @@ static void art_insert_sparse(state &s) {
   art::art<int*> m;
   int v = 1;
   std::mt19937_64 rng(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.set(std::to_string(rng()).c_str(), &v);
+  key_set keys(s.iterations(), [&rng]() { return std::to_string(rng()); });
+  for (auto i : perf::measure(s, __func__)) {
+    m.set(keys[i], &v);
   }
 }
 PICOBENCH(art_insert_sparse);
@@ -30,8 +32,11 @@ static void red_black_insert_sparse(state &s) {
   std::map<std::string, int> m;
   int v = 1;
   std::mt19937_64 rng(0);
-  for (auto i __attribute__((unused)) : s) {
-    m[std::to_string(rng())] = v;
+  std::vector<std::string> keys =
+      key_set(s.iterations(), [&rng]() { return std::to_string(rng()); })
+          .to_strings();
+  for (auto i : perf::measure(s, __func__)) {
+    m[keys[i]] = v;
   }
 }
 PICOBENCH(red_black_insert_sparse);
@@ -39,10 +44,12 @@ PICOBENCH(red_black_insert_sparse);
 static void hashmap_insert_sparse(state &s) {
   std::unordered_map<std::string, int> m;
   int v = 1;
-  std::random_device rd;
-  std::mt19937_64 g(rd());
-  for (auto i __attribute__((unused)) : s) {
-    m[std::to_string(g())] = v;
+  std::mt19937_64 rng(0);
+  std::vector<std::string> keys =
+      key_set(s.iterations(), [&rng]() { return std::to_string(rng()); })
+          .to_strings();
+  for (auto i : perf::measure(s, __func__)) {
+    m[keys[i]] = v;
   }
 }
 PICOBENCH(hashmap_insert_sparse);
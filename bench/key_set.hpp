@@ -0,0 +1,99 @@
+/**
+ * @file pre-materialized benchmark keys
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef BENCH_KEY_SET_HPP
+#define BENCH_KEY_SET_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * View of a null-terminated key stored in a key_set's arena.
+ */
+struct key_view {
+  const char *data_;
+  uint32_t size_;
+};
+
+/**
+ * Keys generated before timing starts and stored back to back, null
+ * terminated, in one contiguous arena, so that a timed loop only indexes the
+ * view array instead of formatting and allocating keys.
+ */
+class key_set {
+public:
+  /**
+   * Generates n keys by calling next n times.
+   */
+  key_set(size_t n, std::function<std::string()> next);
+
+  explicit key_set(const std::vector<std::string> &keys);
+
+  key_set(const key_set &other) = delete;
+  key_set &operator=(const key_set &other) = delete;
+
+  size_t size() const { return views_.size(); }
+
+  const char *operator[](size_t i) const { return views_[i].data_; }
+
+  const key_view &view(size_t i) const { return views_[i]; }
+
+  const std::vector<key_view> &views() const { return views_; }
+
+  /**
+   * Copies the keys into strings, for containers keyed by std::string, to be
+   * called before timing starts as well.
+   */
+  std::vector<std::string> to_strings() const;
+
+private:
+  void materialize(const std::vector<std::string> &keys);
+
+  std::vector<char> arena_;
+  std::vector<key_view> views_;
+};
+
+inline key_set::key_set(size_t n, std::function<std::string()> next) {
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back(next());
+  }
+  materialize(keys);
+}
+
+inline key_set::key_set(const std::vector<std::string> &keys) {
+  materialize(keys);
+}
+
+inline void key_set::materialize(const std::vector<std::string> &keys) {
+  size_t arena_size = 0;
+  for (const std::string &key : keys) {
+    arena_size += key.size() + 1;
+  }
+  /* sized once, views into the arena stay valid */
+  arena_.resize(arena_size);
+  views_.reserve(keys.size());
+  char *cur = arena_.data();
+  for (const std::string &key : keys) {
+    std::copy(key.c_str(), key.c_str() + key.size() + 1, cur);
+    views_.push_back(key_view{cur, static_cast<uint32_t>(key.size())});
+    cur += key.size() + 1;
+  }
+}
+
+inline std::vector<std::string> key_set::to_strings() const {
+  std::vector<std::string> strings;
+  strings.reserve(views_.size());
+  for (const key_view &view : views_) {
+    strings.emplace_back(view.data_, view.size_);
+  }
+  return strings;
+}
+
+#endif
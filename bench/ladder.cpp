@@ -0,0 +1,82 @@
+/**
+ * @file node ladder benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "dataset.hpp"
+#include "perf.hpp"
+#include "picobench/picobench.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using picobench::state;
+using std::mt19937_64;
+using std::string;
+using std::vector;
+
+/* keys loaded before the lookups */
+static const uint32_t n_keys = 100000;
+
+typedef art::default_ladder ladder_default;
+typedef art::node_ladder<art::node_4, art::node_8, art::node_16, art::node_48,
+                         art::node_256>
+    ladder_node_8;
+typedef art::node_ladder<art::node_16, art::node_48, art::node_256>
+    ladder_no_node_4;
+
+template <class Ladder>
+using ladder_art =
+    art::art<int *, art::no_counters, art::hysteresis_shrink, Ladder>;
+
+template <class Ladder>
+static void art_insert_ladder(state &s, const char *name,
+                              const char *benchmark) {
+  vector<string> keys = dataset::generate(name, s.iterations(), 0);
+  ladder_art<Ladder> m;
+  int v = 1;
+  for (auto i : perf::measure(s, benchmark)) {
+    m.set(keys[i].c_str(), &v);
+  }
+  s.set_result(m.memory_stats().total_bytes_);
+}
+
+template <class Ladder>
+static void art_query_ladder(state &s, const char *name,
+                             const char *benchmark) {
+  vector<string> keys = dataset::generate(name, n_keys, 0);
+  ladder_art<Ladder> m;
+  int v = 1;
+  for (const string &key : keys) {
+    m.set(key.c_str(), &v);
+  }
+  mt19937_64 rng(0);
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, benchmark)) {
+    result += reinterpret_cast<uintptr_t>(m.get(keys[rng() % n_keys].c_str()));
+  }
+  s.set_result(result);
+}
+
+#define LADDER_BENCH(op, ladder, name)                                         \
+  static void art_##op##_##ladder##_##name(state &s) {                         \
+    art_##op##_ladder<ladder_##ladder>(s, #name, __func__);                    \
+  }                                                                            \
+  PICOBENCH(art_##op##_##ladder##_##name)
+
+PICOBENCH_SUITE("ladder insert");
+LADDER_BENCH(insert, default, sparse_integers);
+LADDER_BENCH(insert, node_8, sparse_integers);
+LADDER_BENCH(insert, no_node_4, sparse_integers);
+LADDER_BENCH(insert, default, urls);
+LADDER_BENCH(insert, node_8, urls);
+LADDER_BENCH(insert, no_node_4, urls);
+
+PICOBENCH_SUITE("ladder query");
+LADDER_BENCH(query, default, sparse_integers);
+LADDER_BENCH(query, node_8, sparse_integers);
+LADDER_BENCH(query, no_node_4, sparse_integers);
+LADDER_BENCH(query, default, urls);
+LADDER_BENCH(query, node_8, urls);
+LADDER_BENCH(query, no_node_4, urls);
@@ -0,0 +1,134 @@
+/**
+ * @file tail latency benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "histogram.hpp"
+#include "zipf.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::to_string;
+using std::vector;
+
+typedef std::chrono::steady_clock timer;
+
+static const uint32_t max_scan_len = 100;
+
+static uint64_t elapsed_ns(timer::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(timer::now() -
+                                                               start)
+      .count();
+}
+
+static void print(const char *op, const latency_histogram &h) {
+  std::cout << std::setw(8) << op << " |" << std::setw(9) << h.count() << " |"
+            << std::setw(8) << h.percentile(50) << " |" << std::setw(8)
+            << h.percentile(99) << " |" << std::setw(8) << h.percentile(99.9)
+            << " |" << std::setw(9) << h.max() << " |" << std::fixed
+            << std::setprecision(1) << std::setw(10) << h.mean() << std::endl;
+}
+
+/**
+ * Times every single insert, lookup, scan and delete on a tree of n keys.
+ * Inserts hit node growth, e.g., node_48 to node_256, deletes hit shrink
+ * cascades, both show up in the tail rather than in the mean.
+ */
+static void latency(uint32_t n, uint32_t n_scans, bool zipf) {
+  std::hash<uint32_t> h;
+  std::mt19937_64 rng(0);
+  vector<string> keys;
+  if (zipf) {
+    rejection_inversion_zipf zipf_rng(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      keys.push_back(to_string(h(zipf_rng())));
+    }
+  } else {
+    for (uint32_t i = 0; i < n; ++i) {
+      keys.push_back(to_string(h(rng())));
+    }
+  }
+
+  art::art<int *> m;
+  int v = 1;
+  int *v_ptr = &v;
+  latency_histogram timer_overhead, insert, lookup, scan, del;
+  for (uint32_t i = 0; i < n; ++i) {
+    auto start = timer::now();
+    timer_overhead.record(elapsed_ns(start));
+  }
+  for (const string &key : keys) {
+    auto start = timer::now();
+    m.set(key.c_str(), v_ptr);
+    insert.record(elapsed_ns(start));
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (const string &key : keys) {
+    auto start = timer::now();
+    v_ptr = m.get(key.c_str());
+    lookup.record(elapsed_ns(start));
+  }
+  for (uint32_t i = 0; i < n_scans; ++i) {
+    const string &key = keys[rng() % n];
+    auto start = timer::now();
+    auto it = m.begin(key.c_str()), it_end = m.end();
+    for (uint32_t j = 0; j < max_scan_len && it != it_end; ++j, ++it) {
+      v_ptr = *it;
+    }
+    scan.record(elapsed_ns(start));
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (const string &key : keys) {
+    auto start = timer::now();
+    m.del(key.c_str());
+    del.record(elapsed_ns(start));
+  }
+
+  std::cout << n << " keys (" << (zipf ? "zipf" : "uniform")
+            << "), scans of " << max_scan_len << " keys, latencies in ns"
+            << std::endl;
+  std::cout << "      Op |    Count |     p50 |     p99 |   p99.9 |      Max |"
+               "      Mean"
+            << std::endl;
+  print("timer", timer_overhead);
+  print("insert", insert);
+  print("lookup", lookup);
+  print("scan", scan);
+  print("delete", del);
+  /* keeps the lookups from being optimized away */
+  if (v_ptr == nullptr) {
+    std::cout << std::endl;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t n = 1000000;
+  uint32_t n_scans = 100000;
+  bool zipf = false;
+  for (int i = 1; i < argc; ++i) {
+    string arg(argv[i]);
+    if (arg == "--keys" && i + 1 < argc) {
+      n = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--scans" && i + 1 < argc) {
+      n_scans = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--zipf") {
+      zipf = true;
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--keys N] [--scans N] [--zipf]"
+                << std::endl;
+      return 1;
+    }
+  }
+  latency(n, n_scans, zipf);
+  return 0;
+}
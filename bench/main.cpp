@@ -4,10 +4,23 @@
  */
 
 #define PICOBENCH_IMPLEMENT
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
+#include <cstring>
 #include <iostream>
 
 int main(int argc, char *argv[]) {
+  /* --perf is ours, picobench rejects unknown arguments */
+  int n_args = 0;
+  for (int i = 0; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--perf") == 0) {
+      perf::session::instance().enable(std::cerr);
+    } else {
+      argv[n_args++] = argv[i];
+    }
+  }
+  argc = n_args;
+
   picobench::runner runner;
   runner.parse_cmd_line(argc, argv);
   if (runner.should_run()) {
@@ -15,6 +28,7 @@ int main(int argc, char *argv[]) {
     runner.run_benchmarks();
     auto report = runner.generate_report();
     report.to_text(std::cout);
+    perf::session::instance().to_text(std::cout);
   }
   return 0;
 }
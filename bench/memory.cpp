@@ -4,69 +4,228 @@
  */
 
 #include "art.hpp"
+#include "churn.hpp"
+#include "dataset.hpp"
 #include "zipf.hpp"
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <new>
+#include <random>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+using std::hash;
 using std::string;
 using std::to_string;
-using std::hash;
+using std::vector;
 
-// Number of elements to insert for memory benchmarks
-const uint32_t NUM_ELEMENTS = 1000000;
+/**
+ * Live heap bytes and allocations, maintained by the global operator new and
+ * delete below, and allocations ever made. The benchmark is single threaded.
+ */
+static uint64_t live_bytes = 0;
+static uint64_t live_allocations = 0;
+static uint64_t total_allocations = 0;
+
+/* keeps the returned pointers aligned for any type */
+static const size_t header_size = alignof(std::max_align_t);
+
+static void *counted_alloc(size_t size) {
+  void *p = std::malloc(header_size + size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t *>(p) = size;
+  live_bytes += size;
+  ++live_allocations;
+  ++total_allocations;
+  return static_cast<char *>(p) + header_size;
+}
+
+static void counted_free(void *p) {
+  if (p == nullptr) {
+    return;
+  }
+  void *block = static_cast<char *>(p) - header_size;
+  live_bytes -= *static_cast<size_t *>(block);
+  --live_allocations;
+  std::free(block);
+}
+
+void *operator new(size_t size) { return counted_alloc(size); }
+void *operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return counted_alloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return counted_alloc(size);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  counted_free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  counted_free(p);
+}
+
+/* Number of keys to insert per key set */
+static uint32_t n_keys = 1000000;
 
 /**
- * Memory benchmark with uniformly distributed keys
- * Uses nullptr values to measure only data structure overhead
+ * The tree's own accounting from art::memory_stats, for comparison.
  */
-static void memory_uniform() {
-  art::art<int*> m;
-  hash<uint32_t> h;
-  
-  // Fill tree with nullptr values
-  for (uint32_t i = 0; i < NUM_ELEMENTS; i++) {
-    m.set(to_string(h(i)).c_str(), nullptr);
+static string accounted_bytes(const art::art<int *> &m) {
+  return to_string(m.memory_stats().total_bytes_);
+}
+
+static string accounted_bytes(const art::art<void> &s) {
+  return to_string(s.memory_stats().total_bytes_);
+}
+
+template <class Container> static string accounted_bytes(const Container &) {
+  return "-";
+}
+
+/**
+ * Prints the heap growth caused by inserting the keys into an empty
+ * container, i.e., node or entry overhead and key storage. Values are
+ * nullptr to measure only the data structure overhead.
+ */
+template <class Container, class Insert>
+static void measure(const char *key_set, const char *container,
+                    const vector<string> &keys, Insert insert) {
+  uint64_t bytes_before = live_bytes;
+  uint64_t allocations_before = live_allocations;
+  Container *c = new Container();
+  for (const string &key : keys) {
+    insert(*c, key);
   }
-  
-  std::cout << "Inserted " << NUM_ELEMENTS << " elements (uniform distribution)" << std::endl;
+  uint64_t bytes = live_bytes - bytes_before;
+  uint64_t allocations = live_allocations - allocations_before;
+  string accounted = accounted_bytes(*c);
+  delete c;
+
+  std::cout << std::setw(16) << key_set << " |" << std::setw(10) << container
+            << " |" << std::setw(13) << bytes << " |" << std::fixed
+            << std::setprecision(2) << std::setw(10)
+            << static_cast<double>(bytes) / keys.size() << " |"
+            << std::setw(10) << allocations << " |" << std::setw(11)
+            << static_cast<double>(allocations) / keys.size() << " |"
+            << std::setw(13) << accounted << std::endl;
+}
+
+static void measure_all(const char *key_set, const vector<string> &keys) {
+  measure<art::art<int *>>(
+      key_set, "art", keys,
+      [](art::art<int *> &m, const string &key) {
+        m.set(key.c_str(), nullptr);
+      });
+  measure<art::art<void>>(
+      key_set, "art<void>", keys,
+      [](art::art<void> &s, const string &key) { s.insert(key.c_str()); });
+  measure<std::map<string, int *>>(
+      key_set, "map", keys,
+      [](std::map<string, int *> &m, const string &key) { m[key] = nullptr; });
+  measure<std::unordered_map<string, int *>>(
+      key_set, "hashmap", keys,
+      [](std::unordered_map<string, int *> &m, const string &key) {
+        m[key] = nullptr;
+      });
 }
 
 /**
- * Memory benchmark with Zipfian distributed keys
- * Uses nullptr values to measure only data structure overhead
+ * Prints the allocations made by churn steps, i.e., by growing and shrinking
+ * nodes whose number of children oscillates around the capacity.
  */
-static void memory_zipf() {
-  art::art<int*> m;
-  hash<uint32_t> h;
-  fast_zipf rng(NUM_ELEMENTS);
-  
-  // Fill tree with nullptr values
-  for (uint32_t i = 0; i < NUM_ELEMENTS; i++) {
-    m.set(to_string(h(rng())).c_str(), nullptr);
+template <class Shrink>
+static void measure_churn(const char *policy, int capacity) {
+  key_set keys(churn::keys(capacity));
+  std::vector<uint32_t> steps = churn::steps(n_keys, capacity);
+  art::art<int *, art::no_counters, Shrink> m;
+  churn::fill(m, keys, nullptr);
+  uint64_t allocations_before = total_allocations;
+  for (uint32_t child : steps) {
+    churn::step(m, keys, child, nullptr);
+  }
+  uint64_t allocations = total_allocations - allocations_before;
+  std::cout << std::setw(10) << policy << " |" << std::setw(9) << capacity
+            << " |" << std::setw(10) << steps.size() << " |" << std::setw(12)
+            << allocations << " |" << std::fixed << std::setprecision(2)
+            << std::setw(11) << static_cast<double>(allocations) / steps.size()
+            << std::endl;
+}
+
+/**
+ * Distinct keys drawn from the generator, duplicates are dropped so every
+ * container holds the same number of keys.
+ */
+static vector<string> draw(std::function<string()> next) {
+  vector<string> keys;
+  std::unordered_set<string> seen;
+  for (uint32_t i = 0; i < n_keys; ++i) {
+    string key = next();
+    if (seen.insert(key).second) {
+      keys.push_back(key);
+    }
   }
-  
-  std::cout << "Inserted " << NUM_ELEMENTS << " elements (zipfian distribution)" << std::endl;
+  return keys;
 }
 
 int main(int argc, char *argv[]) {
-  if (argc < 2) {
-    std::cerr << "Usage: " << argv[0] << " <uniform|zipf>" << std::endl;
+  if (argc > 2 || (argc == 2 && std::atoi(argv[1]) <= 0)) {
+    std::cerr << "Usage: " << argv[0] << " [number of keys]" << std::endl;
     return 1;
   }
-  
-  std::string mode(argv[1]);
-  
-  if (mode == "uniform") {
-    memory_uniform();
-  } else if (mode == "zipf") {
-    memory_zipf();
-  } else {
-    std::cerr << "Unknown mode: " << mode << std::endl;
-    std::cerr << "Valid modes: uniform, zipf" << std::endl;
-    return 1;
+  if (argc == 2) {
+    n_keys = std::atoi(argv[1]);
+  }
+
+  std::cout << "Live heap bytes and allocations after inserting up to "
+            << n_keys << " keys" << std::endl;
+  std::cout << "         Key set | Container |        Bytes | Bytes/key |"
+               "    Allocs | Allocs/key |    Accounted"
+            << std::endl;
+
+  hash<uint32_t> h;
+  std::mt19937_64 rng(0);
+  measure_all("uniform", draw([&]() { return to_string(h(rng())); }));
+
+  fast_zipf zipf_rng(n_keys);
+  measure_all("zipf", draw([&]() { return to_string(h(zipf_rng())); }));
+
+  measure_all("integers", dataset::sparse_integers(n_keys, 0));
+  measure_all("urls", dataset::urls(n_keys, 0));
+
+  std::cout << std::endl
+            << "Allocations of " << n_keys
+            << " churn steps, each deletes and reinserts a child of a node "
+               "with capacity + 1 children"
+            << std::endl;
+  std::cout << "    Shrink | Capacity |     Steps | Allocations | Allocs/step"
+            << std::endl;
+  for (int capacity : {4, 16, 48}) {
+    measure_churn<art::eager_shrink>("eager", capacity);
+    measure_churn<art::hysteresis_shrink>("hysteresis", capacity);
   }
-  
   return 0;
 }
@@ -4,26 +4,23 @@
  */
 
 #include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include "zipf.hpp"
-#include <fstream>
 #include <functional>
-#include <iostream>
 #include <map>
-#include <queue>
-#include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 using picobench::state;
-using std::getline;
 using std::hash;
-using std::ifstream;
 using std::map;
-using std::mt19937_64;
 using std::string;
 using std::to_string;
 using std::unordered_map;
+using std::vector;
 
 PICOBENCH_SUITE("mixed");
 
@@ -31,14 +28,13 @@ static void art_mixed_sparse(state &s) {
   art::art<int*> m;
   fast_zipf rng(10000000);
   hash<uint32_t> h;
-  string k;
+  key_set keys(s.iterations(), [&]() { return to_string(h(rng())); });
   int v = 1;
-  for (auto i __attribute__((unused)) : s) {
-    k = to_string(h(rng()));
-    if (m.get(k.c_str()) == nullptr) {
-      m.set(k.c_str(), &v);
+  for (auto i : perf::measure(s, __func__)) {
+    if (m.get(keys[i]) == nullptr) {
+      m.set(keys[i], &v);
     } else {
-      m.del(k.c_str());
+      m.del(keys[i]);
     }
   }
 }
@@ -48,10 +44,12 @@ static void red_black_mixed_sparse(state &s) {
   map<string, int *> m;
   fast_zipf rng(10000000);
   hash<uint32_t> h;
-  string k;
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
   int v = 1;
-  for (auto i __attribute__((unused)) : s) {
-    k = to_string(h(rng()));
+  for (auto i : perf::measure(s, __func__)) {
+    const string &k = keys[i];
     if (m[k] == nullptr) {
       m[k] = &v;
     } else {
@@ -65,10 +63,12 @@ static void hashmap_mixed_sparse(state &s) {
   unordered_map<string, int *> m;
   fast_zipf rng(10000000);
   hash<uint32_t> h;
-  string k;
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
   int v = 1;
-  for (auto i __attribute__((unused)) : s) {
-    k = to_string(h(rng()));
+  for (auto i : perf::measure(s, __func__)) {
+    const string &k = keys[i];
     if (m[k] == nullptr) {
       m[k] = &v;
     } else {
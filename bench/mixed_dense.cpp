@@ -4,80 +4,62 @@
  */
 
 #include "art.hpp"
+#include "dataset.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include "zipf.hpp"
-#include <fstream>
-#include <functional>
-#include <iostream>
+#include <algorithm>
 #include <map>
-#include <queue>
-#include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 using picobench::state;
-using std::getline;
-using std::hash;
-using std::ifstream;
 using std::map;
-using std::mt19937_64;
 using std::string;
-using std::to_string;
 using std::unordered_map;
+using std::vector;
 
 PICOBENCH_SUITE("mixed_dense");
 
-static void art_mixed(state &s) __attribute__((unused));
+/* keys generated if dataset.txt is absent */
+static const uint32_t n_keys = 1000000;
+
 static void art_mixed(state &s) {
-  ifstream file("dataset.txt");
-  if (!file) {
-    return;
-  }
-  unordered_map<uint32_t, string> dataset;
-  uint32_t n = 0;
-  string line;
-  while (getline(file, line)) {
-    dataset[n++] = line;
-  }
-  file.close();
+  vector<string> keys = dataset::load_or_generate("dataset.txt", n_keys, 0);
+  uint32_t n = keys.size();
 
   int v = 1;
   fast_zipf rng(n);
 
+  key_set ops(s.iterations(), [&]() { return keys[std::min(rng(), n - 1)]; });
+
   art::art<int*> m;
-  string k;
-  for (auto i __attribute__((unused)) : s) {
-    k = dataset[rng()];
-    if (m.get(k.c_str()) == nullptr) {
-      m.set(k.c_str(), &v);
+  for (auto i : perf::measure(s, __func__)) {
+    if (m.get(ops[i]) == nullptr) {
+      m.set(ops[i], &v);
     } else {
-      m.del(k.c_str());
+      m.del(ops[i]);
     }
   }
 }
-/* PICOBENCH(art_mixed).iterations({1000000}); */
+PICOBENCH(art_mixed).iterations({1000000});
 
-static void red_black_mixed(state &s) __attribute__((unused));
 static void red_black_mixed(state &s) {
-  ifstream file("dataset.txt");
-  if (!file) {
-    return;
-  }
-  unordered_map<uint32_t, string> dataset;
-  uint32_t n = 0;
-  string line;
-  while (getline(file, line)) {
-    dataset[n++] = line;
-  }
-  file.close();
+  vector<string> keys = dataset::load_or_generate("dataset.txt", n_keys, 0);
+  uint32_t n = keys.size();
 
   int v = 1;
   fast_zipf rng(n);
 
+  vector<string> ops =
+      key_set(s.iterations(), [&]() { return keys[std::min(rng(), n - 1)]; })
+          .to_strings();
+
   map<string, int *> m;
-  string k;
-  for (auto i __attribute__((unused)) : s) {
-    k = dataset[rng()];
+  for (auto i : perf::measure(s, __func__)) {
+    const string &k = ops[i];
     if (m[k] == nullptr) {
       m[k] = &v;
     } else {
@@ -85,29 +67,22 @@ static void red_black_mixed(state &s) {
     }
   }
 }
-/* PICOBENCH(red_black_mixed).iterations({1000000}); */
+PICOBENCH(red_black_mixed).iterations({1000000});
 
-static void hashmap_mixed(state &s) __attribute__((unused));
 static void hashmap_mixed(state &s) {
-  ifstream file("dataset.txt");
-  if (!file) {
-    return;
-  }
-  unordered_map<uint32_t, string> dataset;
-  uint32_t n = 0;
-  string line;
-  while (getline(file, line)) {
-    dataset[n++] = line;
-  }
-  file.close();
+  vector<string> keys = dataset::load_or_generate("dataset.txt", n_keys, 0);
+  uint32_t n = keys.size();
 
   int v = 1;
   fast_zipf rng(n);
 
+  vector<string> ops =
+      key_set(s.iterations(), [&]() { return keys[std::min(rng(), n - 1)]; })
+          .to_strings();
+
   unordered_map<string, int *> m;
-  string k;
-  for (auto i __attribute__((unused)) : s) {
-    k = dataset[rng()];
+  for (auto i : perf::measure(s, __func__)) {
+    const string &k = ops[i];
     if (m[k] == nullptr) {
       m[k] = &v;
     } else {
@@ -115,4 +90,4 @@ static void hashmap_mixed(state &s) {
     }
   }
 }
-/* PICOBENCH(hashmap_mixed).iterations({1000000}); */
+PICOBENCH(hashmap_mixed).iterations({1000000});
@@ -0,0 +1,287 @@
+/**
+ * @file multi-threaded scalability benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "zipf.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::hash;
+using std::string;
+using std::to_string;
+using std::vector;
+
+/**
+ * Synchronizes the tree with a single mutex, readers exclude each other.
+ */
+class mutex_sync {
+public:
+  static const char *name() { return "mutex"; }
+
+  void lock() { mutex_.lock(); }
+  void unlock() { mutex_.unlock(); }
+  void lock_shared() { mutex_.lock(); }
+  void unlock_shared() { mutex_.unlock(); }
+
+private:
+  std::mutex mutex_;
+};
+
+/**
+ * Synchronizes the tree with a reader-writer lock, readers run concurrently.
+ */
+class rwlock_sync {
+public:
+  static const char *name() { return "rwlock"; }
+
+  rwlock_sync() { pthread_rwlock_init(&rwlock_, nullptr); }
+  ~rwlock_sync() { pthread_rwlock_destroy(&rwlock_); }
+
+  void lock() { pthread_rwlock_wrlock(&rwlock_); }
+  void unlock() { pthread_rwlock_unlock(&rwlock_); }
+  void lock_shared() { pthread_rwlock_rdlock(&rwlock_); }
+  void unlock_shared() { pthread_rwlock_unlock(&rwlock_); }
+
+private:
+  pthread_rwlock_t rwlock_;
+};
+
+/**
+ * Tree shared by all threads, every operation is guarded by Sync.
+ */
+template <class Sync> class synchronized_art {
+public:
+  int *get(const char *key) {
+    sync_.lock_shared();
+    int *value = tree_.get(key);
+    sync_.unlock_shared();
+    return value;
+  }
+
+  void set(const char *key, int *value) {
+    sync_.lock();
+    tree_.set(key, value);
+    sync_.unlock();
+  }
+
+  void del(const char *key) {
+    sync_.lock();
+    tree_.del(key);
+    sync_.unlock();
+  }
+
+private:
+  Sync sync_;
+  art::art<int *> tree_;
+};
+
+/**
+ * Percentages of get and set operations, the remainder are deletions.
+ */
+struct mix {
+  const char *name_;
+  int get_;
+  int set_;
+};
+
+static const mix mixes[] = {
+    {"read-only", 100, 0},
+    {"read-mostly", 95, 5},
+    {"write-heavy", 50, 25},
+};
+
+struct options {
+  unsigned threads_ = std::max(1u, std::thread::hardware_concurrency());
+  double seconds_ = 1;
+  uint32_t keys_ = 1000000;
+  bool zipf_ = false;
+  bool pin_ = true;
+  string sync_ = "all";
+};
+
+static void pin(std::thread &thread, unsigned cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+  (void)thread;
+  (void)cpu;
+#endif
+}
+
+/**
+ * Runs the mix on the given number of threads for the configured duration,
+ * returns the operations completed per thread.
+ */
+template <class Sync>
+static vector<uint64_t> run(const options &opts, const mix &m,
+                            unsigned n_threads, const vector<string> &keys) {
+  synchronized_art<Sync> tree;
+  static int v = 1;
+  for (const string &key : keys) {
+    tree.set(key.c_str(), &v);
+  }
+
+  std::atomic<unsigned> n_ready(0);
+  std::atomic<bool> is_started(false), is_stopped(false);
+  /* written once per thread after the run, no false sharing */
+  vector<uint64_t> n_ops(n_threads);
+  vector<std::thread> threads;
+  for (unsigned t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 rng(t);
+      scrambled_zipf zipf_rng(keys.size(), 1.0, t);
+      uint64_t n = 0;
+      ++n_ready;
+      while (!is_started.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      while (!is_stopped.load(std::memory_order_relaxed)) {
+        uint32_t i = opts.zipf_ ? zipf_rng() : rng() % keys.size();
+        int op = rng() % 100;
+        if (op < m.get_) {
+          tree.get(keys[i].c_str());
+        } else if (op < m.get_ + m.set_) {
+          tree.set(keys[i].c_str(), &v);
+        } else {
+          tree.del(keys[i].c_str());
+        }
+        ++n;
+      }
+      n_ops[t] = n;
+    });
+    if (opts.pin_) {
+      pin(threads.back(), t);
+    }
+  }
+  while (n_ready.load() < n_threads) {
+    std::this_thread::yield();
+  }
+  is_started.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds_));
+  is_stopped.store(true);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return n_ops;
+}
+
+/**
+ * Prints throughput, speedup over one thread and fairness, i.e., the ratio of
+ * the slowest to the fastest thread and Jain's fairness index, for 1, 2, 4,
+ * ... up to the configured number of threads.
+ */
+template <class Sync>
+static void scaling_curve(const options &opts, const mix &m,
+                          const vector<string> &keys) {
+  vector<unsigned> n_threads;
+  for (unsigned n = 1; n < opts.threads_; n *= 2) {
+    n_threads.push_back(n);
+  }
+  n_threads.push_back(opts.threads_);
+
+  double base_throughput = 0;
+  for (unsigned n : n_threads) {
+    vector<uint64_t> n_ops = run<Sync>(opts, m, n, keys);
+    double sum = 0, sum_sq = 0;
+    for (uint64_t x : n_ops) {
+      sum += x;
+      sum_sq += static_cast<double>(x) * x;
+    }
+    auto min_max = std::minmax_element(n_ops.begin(), n_ops.end());
+    double throughput = sum / opts.seconds_ / 1e6;
+    if (n == 1) {
+      base_throughput = throughput;
+    }
+    std::cout << std::setw(8) << Sync::name() << " |" << std::setw(12)
+              << m.name_ << " |" << std::setw(8) << n << " |" << std::fixed
+              << std::setprecision(3) << std::setw(10) << throughput << " |"
+              << std::setw(8) << std::setprecision(2)
+              << (base_throughput > 0 ? throughput / base_throughput : 0)
+              << " |" << std::setw(9)
+              << (*min_max.second > 0
+                      ? static_cast<double>(*min_max.first) / *min_max.second
+                      : 0)
+              << " |" << std::setw(6)
+              << (sum_sq > 0 ? sum * sum / (n * sum_sq) : 0) << std::endl;
+  }
+}
+
+static void usage(const char *program) {
+  std::cerr << "Usage: " << program
+            << " [--threads N] [--seconds S] [--keys K] [--dist uniform|zipf]"
+               " [--sync mutex|rwlock|all] [--no-pin]"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    string arg(argv[i]);
+    bool has_value = i + 1 < argc;
+    if (arg == "--threads" && has_value) {
+      opts.threads_ = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--seconds" && has_value) {
+      opts.seconds_ = std::atof(argv[++i]);
+    } else if (arg == "--keys" && has_value) {
+      opts.keys_ = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--dist" && has_value) {
+      string dist(argv[++i]);
+      if (dist != "uniform" && dist != "zipf") {
+        usage(argv[0]);
+        return 1;
+      }
+      opts.zipf_ = dist == "zipf";
+    } else if (arg == "--sync" && has_value) {
+      opts.sync_ = argv[++i];
+      if (opts.sync_ != "mutex" && opts.sync_ != "rwlock" &&
+          opts.sync_ != "all") {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--no-pin") {
+      opts.pin_ = false;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  hash<uint32_t> h;
+  vector<string> keys;
+  for (uint32_t i = 0; i < opts.keys_; ++i) {
+    keys.push_back(to_string(h(i)));
+  }
+
+  std::cout << opts.keys_ << " keys, " << (opts.zipf_ ? "zipf" : "uniform")
+            << " distribution, " << opts.seconds_ << " s per run, threads "
+            << (opts.pin_ ? "pinned" : "not pinned") << std::endl;
+  std::cout << "    Sync |         Mix | Threads |    Mops/s | Speedup | "
+               "Min/max |  Jain"
+            << std::endl;
+  for (const mix &m : mixes) {
+    if (opts.sync_ != "rwlock") {
+      scaling_curve<mutex_sync>(opts, m, keys);
+    }
+    if (opts.sync_ != "mutex") {
+      scaling_curve<rwlock_sync>(opts, m, keys);
+    }
+  }
+  return 0;
+}
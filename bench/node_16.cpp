@@ -4,15 +4,31 @@
  */
 
 #include "art.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
 
 using namespace art;
 using picobench::state;
 
 PICOBENCH_SUITE("node_16");
 
+/**
+ * Random partial keys drawn before timing starts.
+ */
+static std::vector<char> partial_keys(int n, int modulo, int stride) {
+  std::mt19937_64 rng(0);
+  std::vector<char> keys(n);
+  for (char &key : keys) {
+    key = static_cast<char>(((rng() % modulo) * stride) - 128);
+  }
+  return keys;
+}
+
 static void node_16_constructor(state &s) {
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     node_16<int> n;
   }
 }
@@ -20,31 +36,51 @@ PICOBENCH(node_16_constructor);
 
 static void node_16_find_child(state &s) {
   node_16<int> n;
-  leaf_node<int> child(nullptr);
+  leaf_node<int> child(0);
   for (int i = 0; i < 16; ++i) {
     n.set_child((i * 17) - 128, &child);
   }
-  for (auto i __attribute__((unused)) : s) {
-    auto child_out __attribute__((unused)) = n.find_child(((rand() % 16) * 17) - 128);
+  std::vector<char> keys = partial_keys(s.iterations(), 16, 17);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += reinterpret_cast<uintptr_t>(n.find_child(keys[i]));
   }
+  s.set_result(result);
 }
 PICOBENCH(node_16_find_child);
 
 static void node_16_set_child(state &s) {
   auto n = new node_16<int>();
-  leaf_node<int> child(nullptr);
-  for (auto i __attribute__((unused)) : s) {
+  leaf_node<int> child(0);
+  std::vector<char> keys = partial_keys(s.iterations(), 256, 1);
+  for (auto i : perf::measure(s, __func__)) {
     if (n->is_full()) {
       delete n;
       n = new node_16<int>();
     }
-    n->set_child(((rand() % 16) * 17) - 128, &child);
+    n->set_child(keys[i], &child);
   }
+  delete n;
 }
 PICOBENCH(node_16_set_child);
 
+static void node_16_del_child(state &s) {
+  node_16<int> n;
+  leaf_node<int> child(0);
+  std::vector<char> keys = partial_keys(s.iterations(), 16, 17);
+  for (int i = 0; i < 16; ++i) {
+    n.set_child((i * 17) - 128, &child);
+  }
+  for (auto i : perf::measure(s, __func__)) {
+    /* put the child back right away, the node stays full */
+    n.del_child(keys[i]);
+    n.set_child(keys[i], &child);
+  }
+}
+PICOBENCH(node_16_del_child);
+
 static void node_16_grow(state &s) {
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     auto *n = new node_16<int>();
     auto *new_n = n->grow();
     delete new_n;
@@ -54,24 +90,30 @@ PICOBENCH(node_16_grow);
 
 static void node_16_next_partial_key(state &s) {
   node_16<int> n;
-  leaf_node<int> child(nullptr);
+  leaf_node<int> child(0);
   for (int i = 0; i < 16; ++i) {
     n.set_child((i * 17) - 128, &child);
   }
-  for (auto i __attribute__((unused)) : s) {
-    auto next_partial_key __attribute__((unused)) = n.next_partial_key((rand() % 256) - 128);
+  std::vector<char> keys = partial_keys(s.iterations(), 256, 1);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += n.next_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_16_next_partial_key);
 
 static void node_16_prev_partial_key(state &s) {
   node_16<int> n;
-  leaf_node<int> child(nullptr);
+  leaf_node<int> child(0);
   for (int i = 0; i < 16; ++i) {
     n.set_child((i * 17) - 128, &child);
   }
-  for (auto i __attribute__((unused)) : s) {
-    auto prev_partial_key __attribute__((unused)) = n.prev_partial_key((rand() % 256) - 128);
+  std::vector<char> keys = partial_keys(s.iterations(), 256, 1);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += n.prev_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_16_prev_partial_key);
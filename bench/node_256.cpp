@@ -4,15 +4,40 @@
  */
 
 #include "art.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
 
 using namespace art;
 using picobench::state;
 
 PICOBENCH_SUITE("node_256");
 
+/**
+ * Random partial keys drawn before timing starts.
+ */
+static std::vector<char> partial_keys(int n) {
+  std::mt19937_64 rng(0);
+  std::vector<char> keys(n);
+  for (char &key : keys) {
+    key = (rng() % 256) - 128;
+  }
+  return keys;
+}
+
+/**
+ * Every stride-th partial key has a child, the last one is 127.
+ */
+static void spread_node(node_256<int> &n, node<int> *child, int stride) {
+  for (int i = 255; i >= 0; i -= stride) {
+    n.set_child(i - 128, child);
+  }
+}
+
 static void node_256_constructor(state &s) {
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     node_256<int> n;
   }
 }
@@ -20,49 +45,83 @@ PICOBENCH(node_256_constructor);
 
 static void node_256_find_child(state &s) {
   node_256<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 256; ++i) {
-    n.set_child(i - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto child = n.find_child((rand() % 256) - 128);
+  leaf_node<int> child(0);
+  spread_node(n, &child, 1);
+  std::vector<char> keys = partial_keys(s.iterations());
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += reinterpret_cast<uintptr_t>(n.find_child(keys[i]));
   }
+  s.set_result(result);
 }
 PICOBENCH(node_256_find_child);
 
 static void node_256_set_child(state &s) {
   node_256<int> *n = new node_256<int>();
-  leaf_node<int> child(nullptr);
-  for (auto i __attribute__((unused)) : s) {
+  leaf_node<int> child(0);
+  std::vector<char> keys = partial_keys(s.iterations());
+  for (auto i : perf::measure(s, __func__)) {
     if (n->is_full()) {
       delete n;
       n = new node_256<int>();
     }
-    n->set_child((rand() % 256) - 128, &child);
+    n->set_child(keys[i], &child);
   }
+  delete n;
 }
 PICOBENCH(node_256_set_child);
 
+static void node_256_shrink(state &s) {
+  leaf_node<int> child(0);
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
+    node_256<int> *n = new node_256<int>();
+    /* 48 children, as when a node_256 becomes underfull */
+    for (int j = 0; j < 48; ++j) {
+      n->set_child(5 * j - 128, &child);
+    }
+    node<int> *new_n = n->shrink();
+    delete new_n;
+  }
+}
+PICOBENCH(node_256_shrink);
+
 static void node_256_next_partial_key(state &s) {
   node_256<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 256; ++i) {
-    n.set_child(i - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto next_partial_key = n.next_partial_key((rand() % 256) - 128);
+  leaf_node<int> child(0);
+  spread_node(n, &child, 16);
+  std::vector<char> keys = partial_keys(s.iterations());
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += n.next_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_256_next_partial_key);
 
 static void node_256_prev_partial_key(state &s) {
   node_256<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 256; ++i) {
-    n.set_child(i - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto prev_partial_key = n.prev_partial_key((rand() % 256) - 128);
+  leaf_node<int> child(0);
+  spread_node(n, &child, 16);
+  n.set_child(-128, &child);
+  std::vector<char> keys = partial_keys(s.iterations());
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += n.prev_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_256_prev_partial_key);
+
+static void node_256_iterate(state &s) {
+  node_256<int> n;
+  leaf_node<int> child(0);
+  spread_node(n, &child, 4);
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
+    for (auto it = n.begin(), it_end = n.end(); it != it_end; ++it) {
+      result += *it;
+    }
+  }
+  s.set_result(result);
+}
+PICOBENCH(node_256_iterate);
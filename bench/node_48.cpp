@@ -4,16 +4,43 @@
  */
 
 #include "art.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
 
 using namespace art;
 using picobench::state;
 
 PICOBENCH_SUITE("node_48");
 
+/**
+ * Random partial keys drawn before timing starts, either any of the 256 or
+ * one of the 48 spread by full_node.
+ */
+static std::vector<char> partial_keys(int n, bool children_only) {
+  std::mt19937_64 rng(0);
+  std::vector<char> keys(n);
+  for (char &key : keys) {
+    key = children_only ? std::floor(5.4468 * (rng() % 48)) - 128
+                        : (rng() % 256) - 128;
+  }
+  return keys;
+}
+
+/**
+ * 48 children spread over the whole partial key domain.
+ */
+static void full_node(node_48<int> &n, node<int> *child) {
+  for (int i = 0; i < 48; ++i) {
+    n.set_child(std::floor(5.4468 * i) - 128, child);
+  }
+}
+
 static void node_48_constructor(state &s) {
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     node_48<int> n;
   }
 }
@@ -21,32 +48,50 @@ PICOBENCH(node_48_constructor);
 
 static void node_48_find_child(state &s) {
   node_48<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 48; ++i) {
-    n.set_child(std::floor(5.4468 * i) - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto child = n.find_child(std::floor(5.4468 * (rand() % 48)) - 128);
+  leaf_node<int> child(0);
+  full_node(n, &child);
+  std::vector<char> keys = partial_keys(s.iterations(), true);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += reinterpret_cast<uintptr_t>(n.find_child(keys[i]));
   }
+  s.set_result(result);
 }
 PICOBENCH(node_48_find_child);
 
 static void node_48_set_child(state &s) {
   node_48<int> *n = new node_48<int>();
-  leaf_node<int> child(nullptr);
-  for (auto i __attribute__((unused)) : s) {
+  leaf_node<int> child(0);
+  std::vector<char> keys = partial_keys(s.iterations(), false);
+  for (auto i : perf::measure(s, __func__)) {
     if (n->is_full()) {
       delete n;
       n = new node_48<int>();
     }
-    n->set_child((rand() % 256) - 128, &child);
+    n->set_child(keys[i], &child);
   }
+  delete n;
 }
 PICOBENCH(node_48_set_child);
 
+static void node_48_del_child(state &s) {
+  node_48<int> n;
+  leaf_node<int> child(0);
+  full_node(n, &child);
+  std::vector<char> keys = partial_keys(s.iterations(), true);
+  for (auto i : perf::measure(s, __func__)) {
+    /* put the child back right away, the node stays full */
+    n.del_child(keys[i]);
+    n.set_child(keys[i], &child);
+  }
+}
+PICOBENCH(node_48_del_child);
+
 static void node_48_grow(state &s) {
-  for (auto i __attribute__((unused)) : s) {
+  leaf_node<int> child(0);
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     node_48<int> *n = new node_48<int>();
+    full_node(*n, &child);
     node<int> *new_n = n->grow();
     delete new_n;
   }
@@ -55,24 +100,27 @@ PICOBENCH(node_48_grow);
 
 static void node_48_next_partial_key(state &s) {
   node_48<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 48; ++i) {
-    n.set_child(std::floor(5.4468 * i) - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto next_partial_key = n.next_partial_key((rand() % 256) - 128);
+  leaf_node<int> child(0);
+  full_node(n, &child);
+  std::vector<char> keys = partial_keys(s.iterations(), false);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    /* the last child is 127, every partial key has a successor */
+    result += n.next_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_48_next_partial_key);
 
 static void node_48_prev_partial_key(state &s) {
   node_48<int> n;
-  leaf_node<int> child(nullptr);
-  for (int i = 0; i < 48; ++i) {
-    n.set_child(std::floor(5.4468 * i) - 128, &child);
-  }
-  for (auto i __attribute__((unused)) : s) {
-    auto prev_partial_key = n.prev_partial_key((rand() % 256) - 128);
+  leaf_node<int> child(0);
+  full_node(n, &child);
+  std::vector<char> keys = partial_keys(s.iterations(), false);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    result += n.prev_partial_key(keys[i]);
   }
+  s.set_result(result);
 }
 PICOBENCH(node_48_prev_partial_key);
@@ -0,0 +1,179 @@
+/**
+ * @file hardware performance counters for the benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "perf.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+#ifdef __linux__
+
+static int open_event(uint32_t type, uint64_t config) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t cache_event(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+#endif
+
+counters::counters() {
+  for (int &fd : fds_) {
+    fd = -1;
+  }
+}
+
+counters::~counters() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+bool counters::open() {
+#ifdef __linux__
+  fds_[cycles] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds_[instructions] =
+      open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[l1d_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D));
+  fds_[llc_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL));
+  fds_[branch_misses] =
+      open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  fds_[dtlb_misses] =
+      open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB));
+#endif
+  return is_open();
+}
+
+bool counters::is_open() const {
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void counters::start() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void counters::stop(int64_t values[n_events]) {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+#endif
+  for (int e = 0; e < n_events; ++e) {
+    values[e] = -1;
+#ifdef __linux__
+    /* value, time enabled, time running */
+    uint64_t buf[3];
+    if (fds_[e] < 0 || read(fds_[e], buf, sizeof(buf)) != sizeof(buf) ||
+        buf[2] == 0) {
+      continue;
+    }
+    values[e] = buf[2] < buf[1]
+                    ? static_cast<int64_t>(static_cast<double>(buf[0]) *
+                                           buf[1] / buf[2])
+                    : static_cast<int64_t>(buf[0]);
+#endif
+  }
+}
+
+session &session::instance() {
+  static session s;
+  return s;
+}
+
+void session::enable(std::ostream &log) {
+  is_enabled_ = counters_.open();
+  if (!is_enabled_) {
+    log << "perf: hardware counters unavailable (perf_event_open failed, "
+           "check /proc/sys/kernel/perf_event_paranoid), continuing without"
+        << std::endl;
+  }
+}
+
+bool session::is_enabled() const { return is_enabled_; }
+
+void session::start() { counters_.start(); }
+
+void session::stop(const char *benchmark, int iterations) {
+  int64_t values[n_events];
+  counters_.stop(values);
+  record &r = records_[std::make_pair(std::string(benchmark), iterations)];
+  ++r.samples_;
+  for (int e = 0; e < n_events; ++e) {
+    r.values_[e] = values[e] < 0 || r.values_[e] < 0 ? -1
+                                                     : r.values_[e] + values[e];
+  }
+}
+
+void session::to_text(std::ostream &out) const {
+  static const char *names[] = {"cycles", "instr", "L1D miss",
+                                "LLC miss", "br miss", "dTLB miss"};
+  if (!is_enabled_ || records_.empty()) {
+    return;
+  }
+  out << std::endl << "Hardware counters per operation" << std::endl;
+  out << std::setw(32) << "Name" << " |" << std::setw(9) << "Dim";
+  for (const char *name : names) {
+    out << " |" << std::setw(10) << name;
+  }
+  out << std::endl;
+  for (const auto &entry : records_) {
+    const record &r = entry.second;
+    double n_ops = static_cast<double>(r.samples_) * entry.first.second;
+    out << std::setw(32) << entry.first.first << " |" << std::setw(9)
+        << entry.first.second;
+    for (int e = 0; e < n_events; ++e) {
+      out << " |" << std::setw(10);
+      if (r.values_[e] < 0 || n_ops == 0) {
+        out << "-";
+      } else {
+        out << std::fixed << std::setprecision(2) << r.values_[e] / n_ops;
+      }
+    }
+    out << std::endl;
+  }
+}
+
+} // namespace perf
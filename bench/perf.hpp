@@ -0,0 +1,159 @@
+/**
+ * @file hardware performance counters for the benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef BENCH_PERF_HPP
+#define BENCH_PERF_HPP
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace perf {
+
+/**
+ * Hardware events counted around the timed loop of a benchmark.
+ */
+enum event { cycles, instructions, l1d_misses, llc_misses, branch_misses,
+             dtlb_misses, n_events };
+
+/**
+ * Linux perf_event_open counters, one per event.
+ * Events which cannot be opened, e.g., due to perf_event_paranoid, missing
+ * hardware support or a non-Linux system, are reported as unavailable.
+ */
+class counters {
+public:
+  counters();
+  ~counters();
+
+  counters(const counters &other) = delete;
+  counters &operator=(const counters &other) = delete;
+
+  /**
+   * Opens the counters, returns false if none could be opened.
+   */
+  bool open();
+
+  bool is_open() const;
+
+  void start();
+
+  /**
+   * Stops counting and reads the counts, scaled if the kernel multiplexed
+   * the counters. Unavailable events read as -1.
+   */
+  void stop(int64_t values[n_events]);
+
+private:
+  int fds_[n_events];
+};
+
+/**
+ * Collects counts per benchmark and iteration count and prints them as a
+ * table. Disabled unless enable() succeeds.
+ */
+class session {
+public:
+  static session &instance();
+
+  /**
+   * Opens the counters, prints a note to the given stream if that fails.
+   */
+  void enable(std::ostream &log);
+
+  bool is_enabled() const;
+
+  void start();
+  void stop(const char *benchmark, int iterations);
+
+  /**
+   * Prints the mean counts per operation.
+   */
+  void to_text(std::ostream &out) const;
+
+private:
+  struct record {
+    int64_t samples_ = 0;
+    int64_t values_[n_events] = {};
+  };
+
+  session() = default;
+
+  counters counters_;
+  bool is_enabled_ = false;
+  std::map<std::pair<std::string, int>, record> records_;
+};
+
+/**
+ * Range over a picobench state which counts hardware events while the state
+ * is iterated. Wrap the loop picobench times, i.e., the last one:
+ *
+ *   for (auto i : perf::measure(s, __func__)) { ... }
+ */
+template <class State> class measured_range {
+public:
+  class iterator {
+  public:
+    iterator(typename State::iterator it, measured_range *range)
+        : it_(it), range_(range) {}
+
+    decltype(*std::declval<typename State::iterator>()) operator*() const {
+      return *it_;
+    }
+
+    iterator &operator++() {
+      ++it_;
+      return *this;
+    }
+
+    bool operator!=(const iterator &other) {
+      if (it_ != other.it_) {
+        return true;
+      }
+      range_->stop();
+      return false;
+    }
+
+  private:
+    typename State::iterator it_;
+    measured_range *range_;
+  };
+
+  measured_range(State &s, const char *benchmark)
+      : state_(s), benchmark_(benchmark) {}
+
+  iterator begin() {
+    auto it = state_.begin();
+    if (session::instance().is_enabled()) {
+      session::instance().start();
+    }
+    return iterator(it, this);
+  }
+
+  iterator end() { return iterator(state_.end(), this); }
+
+private:
+  void stop() {
+    if (session::instance().is_enabled() && !is_stopped_) {
+      session::instance().stop(benchmark_, state_.iterations());
+      is_stopped_ = true;
+    }
+  }
+
+  State &state_;
+  const char *benchmark_;
+  bool is_stopped_ = false;
+};
+
+template <class State>
+measured_range<State> measure(State &s, const char *benchmark) {
+  return measured_range<State>(s, benchmark);
+}
+
+} // namespace perf
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @file query microbenchmarks on generated datasets
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "dataset.hpp"
+#include "perf.hpp"
+#include "picobench/picobench.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using picobench::state;
+using std::map;
+using std::mt19937_64;
+using std::string;
+using std::unordered_map;
+using std::vector;
+
+/* keys loaded before the lookups */
+static const uint32_t n_keys = 100000;
+
+static void art_q_d(state &s, const char *name, const char *benchmark) {
+  vector<string> keys = dataset::generate(name, n_keys, 0);
+  art::art<int *> m;
+  int v = 1;
+  int *v_ptr = &v;
+  for (const string &key : keys) {
+    m.set(key.c_str(), v_ptr);
+  }
+  mt19937_64 rng(0);
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, benchmark)) {
+    v_ptr = m.get(keys[rng() % n_keys].c_str());
+    result += reinterpret_cast<uintptr_t>(v_ptr);
+  }
+  s.set_result(result);
+}
+
+/**
+ * Looks the keys up in batches through get_batch, the per-key cost is
+ * reported.
+ */
+static void art_batch_q_d(state &s, const char *name, const char *benchmark) {
+  vector<string> keys = dataset::generate(name, n_keys, 0);
+  art::art<int *> m;
+  int v = 1;
+  for (const string &key : keys) {
+    m.set(key.c_str(), &v);
+  }
+  mt19937_64 rng(0);
+  vector<const char *> queries(s.iterations());
+  for (const char *&query : queries) {
+    query = keys[rng() % n_keys].c_str();
+  }
+  const size_t batch_size = 64;
+  vector<int *> values(batch_size);
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, benchmark)) {
+    if (i % batch_size == 0) {
+      size_t n = std::min(batch_size, queries.size() - i);
+      m.get_batch(queries.data() + i, n, values.data());
+      result += reinterpret_cast<uintptr_t>(values[n - 1]);
+    }
+  }
+  s.set_result(result);
+}
+
+static void red_black_q_d(state &s, const char *name, const char *benchmark) {
+  vector<string> keys = dataset::generate(name, n_keys, 0);
+  map<string, int> m;
+  for (const string &key : keys) {
+    m[key] = 1;
+  }
+  mt19937_64 rng(0);
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, benchmark)) {
+    result += m.find(keys[rng() % n_keys])->second;
+  }
+  s.set_result(result);
+}
+
+static void hashmap_q_d(state &s, const char *name, const char *benchmark) {
+  vector<string> keys = dataset::generate(name, n_keys, 0);
+  unordered_map<string, int> m;
+  for (const string &key : keys) {
+    m[key] = 1;
+  }
+  mt19937_64 rng(0);
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, benchmark)) {
+    result += m.find(keys[rng() % n_keys])->second;
+  }
+  s.set_result(result);
+}
+
+#define DATASET_BENCH(store, name)                                             \
+  static void store##_q_##name(state &s) {                                     \
+    store##_q_d(s, #name, __func__);                                           \
+  }                                                                            \
+  PICOBENCH(store##_q_##name)
+
+PICOBENCH_SUITE("query dense integers");
+DATASET_BENCH(art, dense_integers);
+DATASET_BENCH(art_batch, dense_integers);
+DATASET_BENCH(red_black, dense_integers);
+DATASET_BENCH(hashmap, dense_integers);
+
+PICOBENCH_SUITE("query sparse integers");
+DATASET_BENCH(art, sparse_integers);
+DATASET_BENCH(art_batch, sparse_integers);
+DATASET_BENCH(red_black, sparse_integers);
+DATASET_BENCH(hashmap, sparse_integers);
+
+PICOBENCH_SUITE("query urls");
+DATASET_BENCH(art, urls);
+DATASET_BENCH(red_black, urls);
+DATASET_BENCH(hashmap, urls);
+
+PICOBENCH_SUITE("query emails");
+DATASET_BENCH(art, emails);
+DATASET_BENCH(red_black, emails);
+DATASET_BENCH(hashmap, emails);
+
+PICOBENCH_SUITE("query uuids");
+DATASET_BENCH(art, uuids);
+DATASET_BENCH(red_black, uuids);
+DATASET_BENCH(hashmap, uuids);
+
+PICOBENCH_SUITE("query paths");
+DATASET_BENCH(art, paths);
+DATASET_BENCH(red_black, paths);
+DATASET_BENCH(hashmap, paths);
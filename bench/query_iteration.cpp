@@ -4,6 +4,7 @@
  */
 
 #include "art.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include "zipf.hpp"
 #include <functional>
@@ -31,7 +32,7 @@ static void full_scan_zipf(state &s) {
   for (int i = 0; i < 100000; ++i) {
     m.set(to_string(h(rng())).c_str(), v_ptr);
   }
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     for (it = m.begin(), it_end = m.end(); it != it_end; ++it) {}
   }
 }
@@ -47,7 +48,7 @@ static void full_scan_uniform(state &s) {
   for (int i = 0; i < 100000; ++i) {
     m.set(to_string(h(rng())).c_str(), v_ptr);
   }
-  for (auto i __attribute__((unused)) : s) {
+  for (auto i __attribute__((unused)) : perf::measure(s, __func__)) {
     for (it = m.begin(), it_end = m.end(); it != it_end; ++it) {}
   }
 }
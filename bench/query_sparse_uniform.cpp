@@ -4,14 +4,15 @@
  */
 
 #include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include <functional>
 #include <map>
-#include <queue>
 #include <random>
 #include <string>
 #include <unordered_map>
-#include <utility>
+#include <vector>
 
 using picobench::state;
 using std::string;
@@ -20,6 +21,7 @@ using std::hash;
 using std::mt19937_64;
 using std::map;
 using std::unordered_map;
+using std::vector;
 
 PICOBENCH_SUITE("query sparse uniform");
 
@@ -28,30 +30,57 @@ static void art_q_s_u(state &s) {
   hash<uint32_t> h;
   int v = 1;
   int *v_ptr = &v;
-  mt19937_64 rng1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m.set(to_string(h(rng1())).c_str(), v_ptr);
+  mt19937_64 rng(0);
+  key_set keys(s.iterations(), [&]() { return to_string(h(rng())); });
+  for (size_t i = 0; i < keys.size(); ++i) {
+    m.set(keys[i], v_ptr);
   }
-  mt19937_64 rng2(0);
-  for (auto i __attribute__((unused)) : s) {
-    v_ptr = m.get(to_string(h(rng2())).c_str());
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    v_ptr = m.get(keys[i]);
+    result += reinterpret_cast<uintptr_t>(v_ptr);
   }
+  s.set_result(result);
 }
 PICOBENCH(art_q_s_u)
   /* .iterations({4000000}) */
   ;
 
+static void frozen_art_q_s_u(state &s) {
+  art::art<int*> m;
+  hash<uint32_t> h;
+  int v = 1;
+  int *v_ptr = &v;
+  mt19937_64 rng(0);
+  key_set keys(s.iterations(), [&]() { return to_string(h(rng())); });
+  for (size_t i = 0; i < keys.size(); ++i) {
+    m.set(keys[i], v_ptr);
+  }
+  auto frozen = m.freeze();
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    v_ptr = frozen.get(keys[i]);
+    result += reinterpret_cast<uintptr_t>(v_ptr);
+  }
+  s.set_result(result);
+}
+PICOBENCH(frozen_art_q_s_u)
+  /* .iterations({4000000}) */
+  ;
+
 static void red_black_q_s_u(state &s) {
   map<string, int> m;
   hash<uint32_t> h;
   int v = 1;
-  mt19937_64 rng1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m[to_string(h(rng1()))] = v;
+  mt19937_64 rng(0);
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
+  for (const string &key : keys) {
+    m[key] = v;
   }
-  mt19937_64 rng2(0);
-  for (auto i __attribute__((unused)) : s) {
-    v = m[to_string(h(rng2()))];
+  for (auto i : perf::measure(s, __func__)) {
+    v = m[keys[i]];
   }
 }
 PICOBENCH(red_black_q_s_u)
@@ -62,13 +91,15 @@ static void hashmap_q_s_u(state &s) {
   unordered_map<string, int> m;
   hash<uint32_t> h;
   int v = 1;
-  mt19937_64 rng1(0);
-  for (auto i __attribute__((unused)) : s) {
-    m[to_string(h(rng1()))] = v;
+  mt19937_64 rng(0);
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
+  for (const string &key : keys) {
+    m[key] = v;
   }
-  mt19937_64 rng2(0);
-  for (auto i __attribute__((unused)) : s) {
-    v = m[to_string(h(rng2()))];
+  for (auto i : perf::measure(s, __func__)) {
+    v = m[keys[i]];
   }
 }
 PICOBENCH(hashmap_q_s_u)
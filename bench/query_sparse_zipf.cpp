@@ -4,21 +4,24 @@
  */
 
 #include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
 #include "picobench/picobench.hpp"
 #include "zipf.hpp"
 #include <functional>
 #include <map>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 
 using picobench::state;
 using std::string;
 using std::to_string;
 using std::hash;
-using std::mt19937_64;
 using std::map;
 using std::unordered_map;
+using std::vector;
 
 PICOBENCH_SUITE("query sparse zipf");
 
@@ -27,14 +30,17 @@ static void art_q_s_z(state &s) {
   hash<uint32_t> h;
   int v = 1;
   int *v_ptr = &v;
-  fast_zipf rng1(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    m.set(to_string(h(rng1())).c_str(), v_ptr);
+  fast_zipf rng(1000000);
+  key_set keys(s.iterations(), [&]() { return to_string(h(rng())); });
+  for (size_t i = 0; i < keys.size(); ++i) {
+    m.set(keys[i], v_ptr);
   }
-  fast_zipf rng2(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    v_ptr = m.get(to_string(h(rng2())).c_str());
+  uintptr_t result = 0;
+  for (auto i : perf::measure(s, __func__)) {
+    v_ptr = m.get(keys[i]);
+    result += reinterpret_cast<uintptr_t>(v_ptr);
   }
+  s.set_result(result);
 }
 PICOBENCH(art_q_s_z);
 
@@ -42,13 +48,15 @@ static void red_black_q_s_z(state &s) {
   map<string, int> m;
   hash<uint32_t> h;
   int v = 1;
-  fast_zipf rng1(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    m[to_string(h(rng1()))] = v;
+  fast_zipf rng(1000000);
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
+  for (const string &key : keys) {
+    m[key] = v;
   }
-  fast_zipf rng2(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    v = m[to_string(h(rng2()))];
+  for (auto i : perf::measure(s, __func__)) {
+    v = m[keys[i]];
   }
 }
 PICOBENCH(red_black_q_s_z);
@@ -57,13 +65,15 @@ static void hashmap_q_s_z(state &s) {
   unordered_map<string, int> m;
   hash<uint32_t> h;
   int v = 1;
-  fast_zipf rng1(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    m[to_string(h(rng1()))] = v;
+  fast_zipf rng(1000000);
+  vector<string> keys =
+      key_set(s.iterations(), [&]() { return to_string(h(rng())); })
+          .to_strings();
+  for (const string &key : keys) {
+    m[key] = v;
   }
-  fast_zipf rng2(1000000);
-  for (auto i __attribute__((unused)) : s) {
-    v = m[to_string(h(rng2()))];
+  for (auto i : perf::measure(s, __func__)) {
+    v = m[keys[i]];
   }
 }
 PICOBENCH(hashmap_q_s_z);
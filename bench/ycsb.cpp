@@ -0,0 +1,287 @@
+/**
+ * @file YCSB-style workload benchmarks
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "key_set.hpp"
+#include "perf.hpp"
+#include "picobench/picobench.hpp"
+#include "zipf.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using picobench::state;
+using std::map;
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+using std::unordered_map;
+using std::vector;
+
+/* records loaded before a workload runs */
+static const uint32_t n_records = 100000;
+static const uint32_t max_scan_len = 100;
+/* YCSB's zipfian constant */
+static const double zipf_skew = 0.99;
+
+/**
+ * Mix of operations, the fractions add up to 1.
+ */
+struct workload {
+  double read_;
+  double update_;
+  double insert_;
+  double scan_;
+  double read_modify_write_;
+};
+
+static const workload workload_a = {0.5, 0.5, 0, 0, 0};    // update heavy
+static const workload workload_b = {0.95, 0.05, 0, 0, 0};  // read mostly
+static const workload workload_c = {1, 0, 0, 0, 0};        // read only
+static const workload workload_d = {0.95, 0, 0.05, 0, 0};  // read latest
+static const workload workload_e = {0, 0, 0.05, 0.95, 0};  // short ranges
+static const workload workload_f = {0.5, 0, 0, 0, 0.5};    // read-modify-write
+
+enum class distribution { uniform, zipfian, latest };
+
+/**
+ * Chooses which record an operation accesses.
+ * zipfian favours the first records loaded, latest favours the records
+ * inserted last.
+ */
+class record_chooser {
+public:
+  explicit record_chooser(distribution d)
+      : distribution_(d), rng_(0), zipf_(n_records, zipf_skew, 0) {}
+
+  uint32_t operator()(uint32_t n) {
+    switch (distribution_) {
+    case distribution::uniform:
+      return rng_() % n;
+    case distribution::zipfian:
+      return std::min<uint64_t>(zipf_(), n - 1);
+    case distribution::latest:
+    default:
+      return n - 1 - std::min<uint64_t>(zipf_(), n - 1);
+    }
+  }
+
+private:
+  distribution distribution_;
+  mt19937_64 rng_;
+  rejection_inversion_zipf zipf_;
+};
+
+/**
+ * Key of the i-th record, hashed so that neighbouring records, e.g., the
+ * popular ones, scatter over the key space.
+ */
+static string record_key(uint64_t i) {
+  /* 64-bit FNV-1a */
+  uint64_t hash = 14695981039346656037ull;
+  for (int b = 0; b < 8; ++b, i >>= 8) {
+    hash = (hash ^ (i & 0xff)) * 1099511628211ull;
+  }
+  return "user" + to_string(hash);
+}
+
+/**
+ * The stores access the records by index into a key_set built before timing
+ * starts, containers keyed by std::string copy it into strings up front.
+ */
+class art_store {
+public:
+  explicit art_store(const key_set &keys) : keys_(keys) {}
+
+  void insert(uint32_t i, int *value) { m_.set(keys_[i], value); }
+  void update(uint32_t i, int *value) { m_.set(keys_[i], value); }
+  int *read(uint32_t i) { return m_.get(keys_[i]); }
+
+  int *scan(uint32_t start, uint32_t len, uint32_t) {
+    int *value = nullptr;
+    auto it = m_.begin(keys_[start]), it_end = m_.end();
+    for (uint32_t i = 0; i < len && it != it_end; ++i, ++it) {
+      value = *it;
+    }
+    return value;
+  }
+
+private:
+  const key_set &keys_;
+  art::art<int *> m_;
+};
+
+class red_black_store {
+public:
+  explicit red_black_store(const key_set &keys) : keys_(keys.to_strings()) {}
+
+  void insert(uint32_t i, int *value) { m_[keys_[i]] = value; }
+  void update(uint32_t i, int *value) { m_[keys_[i]] = value; }
+
+  int *read(uint32_t i) {
+    auto it = m_.find(keys_[i]);
+    return it != m_.end() ? it->second : nullptr;
+  }
+
+  int *scan(uint32_t start, uint32_t len, uint32_t) {
+    int *value = nullptr;
+    auto it = m_.lower_bound(keys_[start]), it_end = m_.end();
+    for (uint32_t i = 0; i < len && it != it_end; ++i, ++it) {
+      value = it->second;
+    }
+    return value;
+  }
+
+private:
+  vector<string> keys_;
+  map<string, int *> m_;
+};
+
+class hashmap_store {
+public:
+  explicit hashmap_store(const key_set &keys) : keys_(keys.to_strings()) {}
+
+  void insert(uint32_t i, int *value) { m_[keys_[i]] = value; }
+  void update(uint32_t i, int *value) { m_[keys_[i]] = value; }
+
+  int *read(uint32_t i) {
+    auto it = m_.find(keys_[i]);
+    return it != m_.end() ? it->second : nullptr;
+  }
+
+  /* unordered, emulated by reading the records inserted after the start */
+  int *scan(uint32_t start, uint32_t len, uint32_t n_inserted) {
+    int *value = nullptr;
+    uint32_t end = std::min<uint32_t>(start + len, n_inserted);
+    for (uint32_t i = start; i < end; ++i) {
+      value = read(i);
+    }
+    return value;
+  }
+
+private:
+  vector<string> keys_;
+  unordered_map<string, int *> m_;
+};
+
+/**
+ * Loads the records, then times the workload's operations.
+ * The keys of the records loaded and of those the workload may insert are
+ * generated before timing starts.
+ */
+template <class Store>
+static void ycsb(state &s, const workload &w, distribution d,
+                 const char *benchmark) {
+  uint64_t next_record = 0;
+  key_set keys(n_records + s.iterations(),
+               [&next_record]() { return record_key(next_record++); });
+  Store store(keys);
+  int v = 1;
+  int *v_ptr = &v;
+  uint32_t n_inserted = 0;
+  for (; n_inserted < n_records; ++n_inserted) {
+    store.insert(n_inserted, v_ptr);
+  }
+  record_chooser choose(d);
+  mt19937_64 rng(1);
+  std::uniform_real_distribution<double> op_dist(0, 1);
+  std::uniform_int_distribution<uint32_t> scan_len_dist(1, max_scan_len);
+  /* keeps the reads from being optimized away */
+  uintptr_t result = 0;
+  for (auto i __attribute__((unused)) : perf::measure(s, benchmark)) {
+    double op = op_dist(rng);
+    if ((op -= w.read_) < 0) {
+      v_ptr = store.read(choose(n_inserted));
+    } else if ((op -= w.update_) < 0) {
+      store.update(choose(n_inserted), &v);
+    } else if ((op -= w.insert_) < 0) {
+      store.insert(n_inserted++, &v);
+    } else if ((op -= w.scan_) < 0) {
+      v_ptr = store.scan(choose(n_inserted), scan_len_dist(rng), n_inserted);
+    } else {
+      uint32_t record = choose(n_inserted);
+      v_ptr = store.read(record);
+      store.update(record, v_ptr != nullptr ? v_ptr : &v);
+    }
+    result += reinterpret_cast<uintptr_t>(v_ptr);
+  }
+  s.set_result(result);
+}
+
+#define YCSB_BENCH(store, w, d, n)                                             \
+  static void store##_ycsb_##w##_##d(state &s) {                               \
+    ycsb<store##_store>(s, workload_##w, distribution::d, __func__);           \
+  }                                                                            \
+  PICOBENCH(store##_ycsb_##w##_##d).iterations({n})
+
+PICOBENCH_SUITE("ycsb a");
+YCSB_BENCH(art, a, uniform, 200000);
+YCSB_BENCH(red_black, a, uniform, 200000);
+YCSB_BENCH(hashmap, a, uniform, 200000);
+YCSB_BENCH(art, a, zipfian, 200000);
+YCSB_BENCH(red_black, a, zipfian, 200000);
+YCSB_BENCH(hashmap, a, zipfian, 200000);
+YCSB_BENCH(art, a, latest, 200000);
+YCSB_BENCH(red_black, a, latest, 200000);
+YCSB_BENCH(hashmap, a, latest, 200000);
+
+PICOBENCH_SUITE("ycsb b");
+YCSB_BENCH(art, b, uniform, 200000);
+YCSB_BENCH(red_black, b, uniform, 200000);
+YCSB_BENCH(hashmap, b, uniform, 200000);
+YCSB_BENCH(art, b, zipfian, 200000);
+YCSB_BENCH(red_black, b, zipfian, 200000);
+YCSB_BENCH(hashmap, b, zipfian, 200000);
+YCSB_BENCH(art, b, latest, 200000);
+YCSB_BENCH(red_black, b, latest, 200000);
+YCSB_BENCH(hashmap, b, latest, 200000);
+
+PICOBENCH_SUITE("ycsb c");
+YCSB_BENCH(art, c, uniform, 200000);
+YCSB_BENCH(red_black, c, uniform, 200000);
+YCSB_BENCH(hashmap, c, uniform, 200000);
+YCSB_BENCH(art, c, zipfian, 200000);
+YCSB_BENCH(red_black, c, zipfian, 200000);
+YCSB_BENCH(hashmap, c, zipfian, 200000);
+YCSB_BENCH(art, c, latest, 200000);
+YCSB_BENCH(red_black, c, latest, 200000);
+YCSB_BENCH(hashmap, c, latest, 200000);
+
+PICOBENCH_SUITE("ycsb d");
+YCSB_BENCH(art, d, uniform, 200000);
+YCSB_BENCH(red_black, d, uniform, 200000);
+YCSB_BENCH(hashmap, d, uniform, 200000);
+YCSB_BENCH(art, d, zipfian, 200000);
+YCSB_BENCH(red_black, d, zipfian, 200000);
+YCSB_BENCH(hashmap, d, zipfian, 200000);
+YCSB_BENCH(art, d, latest, 200000);
+YCSB_BENCH(red_black, d, latest, 200000);
+YCSB_BENCH(hashmap, d, latest, 200000);
+
+PICOBENCH_SUITE("ycsb e");
+YCSB_BENCH(art, e, uniform, 20000);
+YCSB_BENCH(red_black, e, uniform, 20000);
+YCSB_BENCH(hashmap, e, uniform, 20000);
+YCSB_BENCH(art, e, zipfian, 20000);
+YCSB_BENCH(red_black, e, zipfian, 20000);
+YCSB_BENCH(hashmap, e, zipfian, 20000);
+YCSB_BENCH(art, e, latest, 20000);
+YCSB_BENCH(red_black, e, latest, 20000);
+YCSB_BENCH(hashmap, e, latest, 20000);
+
+PICOBENCH_SUITE("ycsb f");
+YCSB_BENCH(art, f, uniform, 200000);
+YCSB_BENCH(red_black, f, uniform, 200000);
+YCSB_BENCH(hashmap, f, uniform, 200000);
+YCSB_BENCH(art, f, zipfian, 200000);
+YCSB_BENCH(red_black, f, zipfian, 200000);
+YCSB_BENCH(hashmap, f, zipfian, 200000);
+YCSB_BENCH(art, f, latest, 200000);
+YCSB_BENCH(red_black, f, latest, 200000);
+YCSB_BENCH(hashmap, f, latest, 200000);
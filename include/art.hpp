@@ -7,14 +7,26 @@
 #define ART_HPP
 
 #include "art/art.hpp"
+#include "art/art_fwd.hpp"
+#include "art/art_set.hpp"
 #include "art/child_it.hpp"
+#include "art/counters.hpp"
+#include "art/durable_art.hpp"
+#include "art/frozen_art.hpp"
 #include "art/inner_node.hpp"
 #include "art/leaf_node.hpp"
+#include "art/mapped_art.hpp"
+#include "art/memory_stats.hpp"
 #include "art/node.hpp"
 #include "art/node_16.hpp"
 #include "art/node_256.hpp"
 #include "art/node_4.hpp"
 #include "art/node_48.hpp"
+#include "art/node_8.hpp"
+#include "art/node_ladder.hpp"
+#include "art/serialization.hpp"
+#include "art/simd.hpp"
+#include "art/structure_stats.hpp"
 #include "art/tree_it.hpp"
 
 #endif
@@ -6,21 +6,71 @@
 #ifndef ART_ART_HPP
 #define ART_ART_HPP
 
+#include "art_fwd.hpp"
+#include "counters.hpp"
+#include "frozen_art.hpp"
 #include "leaf_node.hpp"
 #include "inner_node.hpp"
+#include "memory_stats.hpp"
 #include "node.hpp"
+#include "node_16.hpp"
+#include "node_256.hpp"
 #include "node_4.hpp"
+#include "node_48.hpp"
+#include "node_8.hpp"
+#include "node_ladder.hpp"
+#include "serialization.hpp"
+#include "structure_stats.hpp"
 #include "tree_it.hpp"
 #include <algorithm>
 #include <iostream>
 #include <stack>
+#include <utility>
 
 namespace art {
 
-template <class T> class art {
+template <class T> class mapped_art;
+
+/**
+ * Adaptive radix tree.
+ *
+ * @tparam T - Type of the values.
+ * @tparam Counters - Counters policy which counts the code paths taken by
+ * get, set and del, see counter. no_counters compiles to nothing.
+ * @tparam Shrink - When del shrinks inner nodes, see shrink_thresholds.
+ * @tparam Ladder - Inner node classes and their transitions, see node_ladder.
+ */
+template <class T, class Counters, class Shrink, class Ladder> class art {
+  friend class mapped_art<T>;
+  template <class U, class C, class S, class L> friend class art;
+
 public:
+  art() = default;
+
+  /**
+   * Creates a tree sharing all nodes with the other tree in O(1).
+   * Both trees can be modified independently, a write copies only the
+   * nodes on the path it modifies (path copying).
+   */
+  art(const art<T, Counters, Shrink, Ladder> &other);
+  art(art<T, Counters, Shrink, Ladder> &&other) noexcept;
+  art<T, Counters, Shrink, Ladder> &operator=(const art<T, Counters, Shrink, Ladder> &other);
+  art<T, Counters, Shrink, Ladder> &operator=(art<T, Counters, Shrink, Ladder> &&other) noexcept;
   ~art();
 
+  /**
+   * Takes a snapshot of the tree in O(1).
+   * The snapshot shares all nodes with the tree and is not affected by
+   * subsequent writes to the tree, which copy the root-to-leaf path they
+   * modify instead of modifying shared nodes in-place.
+   * Nodes only reachable from a snapshot are freed when the last snapshot
+   * referencing them is destroyed.
+   * A snapshot can be read from another thread while the tree is written.
+   *
+   * @return the snapshot.
+   */
+  art<T, Counters, Shrink, Ladder> snapshot() const;
+
   /**
    * Finds the value associated with the given key.
    *
@@ -29,6 +79,29 @@ public:
    */
   T get(const char *key) const;
 
+  /**
+   * Determines if a value is associated with the given key, counted like get.
+   *
+   * @param key - The key to find.
+   * @return true if the key is in the tree.
+   */
+  bool contains(const char *key) const;
+
+  /**
+   * Finds the values associated with n keys, i.e., values[i] = get(keys[i]).
+   * Up to batch_lanes lookups are interleaved, each advances one node per
+   * round and prefetches its next node, so that the cache misses of
+   * independent lookups overlap instead of stalling one after another.
+   *
+   * @param keys - The keys to find.
+   * @param n - The number of keys.
+   * @param values - Receives the n values.
+   */
+  void get_batch(const char *const *keys, size_t n, T *values) const;
+
+  /* number of lookups in flight in get_batch */
+  static const int batch_lanes = 16;
+
   /**
    * Associates the given key with the given value.
    * If another value is already associated with the given key,
@@ -56,34 +129,179 @@ public:
    * Forward iterator that traverses the tree in lexicographic order.
    */
   tree_it<T> begin();
+  tree_it<T> begin() const;
 
   /**
    * Forward iterator that traverses the tree in lexicographic order starting
    * from the provided key.
    */
   tree_it<T> begin(const char *key);
+  tree_it<T> begin(const char *key) const;
 
   /**
    * Iterator to the end of the lexicographic order.
    */
   tree_it<T> end();
+  tree_it<T> end() const;
+
+  /**
+   * Writes a compact, versioned, pre-order serialization of the tree's node
+   * structure, i.e., node types, prefixes and leaf values, to the stream.
+   *
+   * @param out - The stream to write to.
+   * @param codec - Writes leaf values, see pod_codec.
+   * @throws std::runtime_error if writing to the stream fails.
+   */
+  template <class Codec = pod_codec<T>>
+  void save(std::ostream &out, Codec codec = Codec()) const;
+
+  /**
+   * Replaces the tree's contents with a tree written by save.
+   * Nodes are rebuilt directly, no keys are inserted.
+   *
+   * @param in - The stream to read from.
+   * @param codec - Reads leaf values, must match the codec used by save.
+   * @throws std::runtime_error if the stream is not a valid serialization,
+   * the tree is left unchanged in that case.
+   */
+  template <class Codec = pod_codec<T>>
+  void load(std::istream &in, Codec codec = Codec());
+
+  /**
+   * Converts the tree into an immutable, read-optimized tree.
+   * The frozen tree is independent of this tree.
+   *
+   * @return the frozen tree.
+   * @throws std::length_error if the tree exceeds the frozen layout's 32 bit
+   * offsets.
+   */
+  frozen_art<T> freeze() const;
+
+  /**
+   * Memory usage by node type, prefixes and unused child slots.
+   * The counts are maintained incrementally by set and del, the call is O(1).
+   * Nodes shared with snapshots are accounted to every tree referencing them.
+   *
+   * @return the memory usage of the tree.
+   */
+  ::art::memory_stats memory_stats() const;
+
+  /**
+   * Histograms of leaf depth, fanout per node type and prefix length, and
+   * the utilization of node_48 and node_256.
+   * Visits every node once, iteratively.
+   *
+   * @return the shape of the tree.
+   */
+  ::art::structure_stats structure_stats() const;
 
 private:
+  static const uint32_t SERIALIZATION_MAGIC = 0x00545241; // "ART\0"
+  static const uint32_t SERIALIZATION_VERSION = 1;
+
+  /**
+   * Drops a reference to the given subtree.
+   * Nodes which are no longer referenced are deleted.
+   */
+  static void release(node<T> *root);
+
+  /**
+   * Replaces a shared node with a private copy.
+   *
+   * @return the copy, which takes over the reference to the given node.
+   */
+  static node<T> *copy_on_write(node<T> *n);
+
+  /**
+   * Adds (sign = 1) or removes (sign = -1) a node, including its prefix and
+   * used child slots, to or from the memory counters.
+   */
+  void count_node(const node<T> *n, int sign);
+
+  /**
+   * Advances a lookup by one node.
+   *
+   * @return true if the lookup ended, cur is then the key's leaf or nullptr
+   * if the key is not in the tree.
+   */
+  static bool get_step(node<T> *&cur, const char *key, int &depth,
+                       int key_len);
+
+  /**
+   * The value of a leaf returned by get_step, or a default constructed value
+   * for nullptr.
+   */
+  static T leaf_value(const node<T> *leaf);
+
   node<T> *root_ = nullptr;
+  ::art::memory_stats stats_;
 };
 
-template <class T> art<T>::~art() {
-  if (root_ == nullptr) {
+template <class T, class Counters, class Shrink, class Ladder>
+art<T, Counters, Shrink, Ladder>::art(const art<T, Counters, Shrink, Ladder> &other)
+    : root_(other.root_), stats_(other.stats_) {
+  if (root_ != nullptr) {
+    root_->retain();
+  }
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+art<T, Counters, Shrink, Ladder>::art(art<T, Counters, Shrink, Ladder> &&other) noexcept
+    : root_(other.root_), stats_(other.stats_) {
+  other.root_ = nullptr;
+  other.stats_ = ::art::memory_stats();
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+art<T, Counters, Shrink, Ladder> &art<T, Counters, Shrink, Ladder>::operator=(const art<T, Counters, Shrink, Ladder> &other) {
+  if (other.root_ != nullptr) {
+    other.root_->retain();
+  }
+  release(root_);
+  root_ = other.root_;
+  stats_ = other.stats_;
+  return *this;
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+art<T, Counters, Shrink, Ladder> &
+art<T, Counters, Shrink, Ladder>::operator=(art<T, Counters, Shrink, Ladder> &&other) noexcept {
+  if (this != &other) {
+    release(root_);
+    root_ = other.root_;
+    stats_ = other.stats_;
+    other.root_ = nullptr;
+    other.stats_ = ::art::memory_stats();
+  }
+  return *this;
+}
+
+template <class T, class Counters, class Shrink, class Ladder> art<T, Counters, Shrink, Ladder>::~art() {
+  release(root_);
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+art<T, Counters, Shrink, Ladder> art<T, Counters, Shrink, Ladder>::snapshot() const {
+  return art<T, Counters, Shrink, Ladder>(*this);
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+void art<T, Counters, Shrink, Ladder>::release(node<T> *root) {
+  if (root == nullptr) {
     return;
   }
   std::stack<node<T> *> node_stack;
-  node_stack.push(root_);
+  node_stack.push(root);
   node<T> *cur;
   inner_node<T> *cur_inner;
   child_it<T> it, it_end;
   while (!node_stack.empty()) {
     cur = node_stack.top();
     node_stack.pop();
+    if (!cur->release()) {
+      /* still referenced by another parent or snapshot */
+      continue;
+    }
     if (!cur->is_leaf()) {
       cur_inner = static_cast<inner_node<T>*>(cur);
       for (it = cur_inner->begin(), it_end = cur_inner->end(); it != it_end; ++it) {
@@ -97,34 +315,200 @@ template <class T> art<T>::~art() {
   }
 }
 
-template <class T> 
-T art<T>::get(const char *key) const {
-  node<T> *cur = root_, **child;
+template <class T, class Counters, class Shrink, class Ladder>
+node<T> *art<T, Counters, Shrink, Ladder>::copy_on_write(node<T> *n) {
+  node<T> *copy = n->clone();
+  release(n);
+  return copy;
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+void art<T, Counters, Shrink, Ladder>::count_node(const node<T> *n, int sign) {
+  auto &node_stats = stats_[n->type()];
+  node_stats.count_ += sign;
+  if (!n->is_leaf()) {
+    node_stats.children_ +=
+        sign * static_cast<const inner_node<T> *>(n)->n_children();
+  }
+  stats_.prefix_bytes_ += sign * n->prefix_len_;
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+::art::memory_stats art<T, Counters, Shrink, Ladder>::memory_stats() const {
+  static const uint64_t node_sizes[] = {
+      sizeof(leaf_node<T>), sizeof(node_4<T>),  sizeof(node_16<T>),
+      sizeof(node_48<T>),   sizeof(node_256<T>), sizeof(node_8<T>)};
+  ::art::memory_stats stats = stats_;
+  stats.total_bytes_ = stats.prefix_bytes_;
+  for (int i = 0; i < n_node_types; ++i) {
+    stats.nodes_[i].bytes_ = stats.nodes_[i].count_ * node_sizes[i];
+    stats.total_bytes_ += stats.nodes_[i].bytes_;
+  }
+  const auto &n48 = stats[node_type::node_48];
+  const auto &n256 = stats[node_type::node_256];
+  stats.slack_bytes_ = (n48.count_ * 48 - n48.children_ +
+                        n256.count_ * 256 - n256.children_) *
+                       sizeof(node<T> *);
+  if (stats.n_keys() > 0) {
+    stats.bytes_per_key_ =
+        static_cast<double>(stats.total_bytes_) / stats.n_keys();
+  }
+  return stats;
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+::art::structure_stats art<T, Counters, Shrink, Ladder>::structure_stats() const {
+  struct step {
+    node<T> *node_;
+    size_t depth_;
+    size_t depth_bytes_;
+  };
+  ::art::structure_stats stats;
+  uint64_t slots_48 = 0, used_48 = 0, slots_256 = 0, used_256 = 0;
+  std::stack<step> node_stack;
+  if (root_ != nullptr) {
+    node_stack.push({root_, 0, 0});
+  }
+  inner_node<T> *cur_inner;
+  child_it<T> it, it_end;
+  while (!node_stack.empty()) {
+    step cur = node_stack.top();
+    node_stack.pop();
+    size_t depth_bytes = cur.depth_bytes_ + cur.node_->prefix_len_;
+    ::art::structure_stats::add(stats.prefix_len_, cur.node_->prefix_len_);
+    if (cur.node_->is_leaf()) {
+      ::art::structure_stats::add(stats.leaf_depth_, cur.depth_);
+      ::art::structure_stats::add(stats.leaf_depth_bytes_, depth_bytes);
+      continue;
+    }
+    cur_inner = static_cast<inner_node<T> *>(cur.node_);
+    int n_children = cur_inner->n_children();
+    node_type type = cur_inner->type();
+    ::art::structure_stats::add(stats.fanout_[static_cast<int>(type)],
+                                n_children);
+    if (type == node_type::node_48) {
+      slots_48 += 48;
+      used_48 += n_children;
+    } else if (type == node_type::node_256) {
+      slots_256 += 256;
+      used_256 += n_children;
+    }
+    for (it = cur_inner->begin(), it_end = cur_inner->end(); it != it_end;
+         ++it) {
+      node_stack.push(
+          {*cur_inner->find_child(*it), cur.depth_ + 1, depth_bytes + 1});
+    }
+  }
+  if (slots_48 > 0) {
+    stats.node_48_utilization_ = static_cast<double>(used_48) / slots_48;
+  }
+  if (slots_256 > 0) {
+    stats.node_256_utilization_ = static_cast<double>(used_256) / slots_256;
+  }
+  return stats;
+}
+
+template <class T, class Counters, class Shrink, class Ladder> 
+T art<T, Counters, Shrink, Ladder>::get(const char *key) const {
+  node<T> *cur = root_;
   int depth = 0, key_len = std::strlen(key) + 1;
-  while (cur != nullptr) {
-    if (cur->prefix_len_ != cur->check_prefix(key + depth, key_len - depth)) {
-      /* prefix mismatch */
-      return T{};
+  while (!get_step(cur, key, depth, key_len)) {
+  }
+  return leaf_value(cur);
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+bool art<T, Counters, Shrink, Ladder>::contains(const char *key) const {
+  node<T> *cur = root_;
+  int depth = 0, key_len = std::strlen(key) + 1;
+  while (!get_step(cur, key, depth, key_len)) {
+  }
+  return cur != nullptr;
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+void art<T, Counters, Shrink, Ladder>::get_batch(const char *const *keys, size_t n,
+                                 T *values) const {
+  struct lane {
+    node<T> *cur;
+    int depth, key_len;
+    size_t i;
+  };
+  auto start = [this, keys](size_t i) {
+    return lane{root_, 0, static_cast<int>(std::strlen(keys[i])) + 1, i};
+  };
+  lane lanes[batch_lanes];
+  int n_lanes = 0;
+  size_t next = 0;
+  for (; n_lanes < batch_lanes && next < n; ++n_lanes) {
+    lanes[n_lanes] = start(next++);
+  }
+  while (n_lanes > 0) {
+    for (int l = 0; l < n_lanes;) {
+      lane &cur = lanes[l];
+      if (!get_step(cur.cur, keys[cur.i], cur.depth, cur.key_len)) {
+        /* the next round reads the child, fetch it meanwhile */
+        __builtin_prefetch(cur.cur);
+        ++l;
+        continue;
+      }
+      values[cur.i] = leaf_value(cur.cur);
+      if (next < n) {
+        /* reuse the lane for the next key */
+        cur = start(next++);
+        ++l;
+      } else {
+        cur = lanes[--n_lanes];
+      }
     }
-    if (cur->prefix_len_ == key_len - depth) {
-      /* exact match */
-      return cur->is_leaf() ? static_cast<leaf_node<T>*>(cur)->value_ : T{};
+  }
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+bool art<T, Counters, Shrink, Ladder>::get_step(node<T> *&cur, const char *key, int &depth,
+                                int key_len) {
+  if (cur == nullptr) {
+    Counters::add(counter::get_miss);
+    return true;
+  }
+  Counters::add(counter::nodes_visited);
+  if (cur->prefix_len_ != cur->check_prefix(key + depth, key_len - depth)) {
+    /* prefix mismatch */
+    Counters::add(counter::get_miss);
+    cur = nullptr;
+    return true;
+  }
+  if (cur->prefix_len_ == key_len - depth) {
+    /* exact match */
+    Counters::add(cur->is_leaf() ? counter::get_hit : counter::get_miss);
+    if (!cur->is_leaf()) {
+      cur = nullptr;
     }
-    child = static_cast<inner_node<T>*>(cur)->find_child(key[depth + cur->prefix_len_]);
-    depth += (cur->prefix_len_ + 1);
-    cur = child != nullptr ? *child : nullptr;
+    return true;
   }
-  return T{};
+  node<T> **child =
+      static_cast<inner_node<T>*>(cur)->find_child(key[depth + cur->prefix_len_]);
+  depth += (cur->prefix_len_ + 1);
+  cur = child != nullptr ? *child : nullptr;
+  return false;
 }
 
-template <class T> 
-T art<T>::set(const char *key, T value) {
+template <class T, class Counters, class Shrink, class Ladder>
+T art<T, Counters, Shrink, Ladder>::leaf_value(const node<T> *leaf) {
+  return leaf != nullptr ? static_cast<const leaf_node<T> *>(leaf)->value_
+                         : T{};
+}
+
+template <class T, class Counters, class Shrink, class Ladder> 
+T art<T, Counters, Shrink, Ladder>::set(const char *key, T value) {
   int key_len = std::strlen(key) + 1, depth = 0, prefix_match_len;
   if (root_ == nullptr) {
     root_ = new leaf_node<T>(value);
     root_->prefix_ = new char[key_len];
     std::copy(key, key + key_len, root_->prefix_);
     root_->prefix_len_ = key_len;
+    count_node(root_, 1);
+    Counters::add(counter::set_root);
     return T{};
   }
 
@@ -134,6 +518,12 @@ T art<T>::set(const char *key, T value) {
   bool is_prefix_match;
 
   while (true) {
+    Counters::add(counter::nodes_visited);
+    if ((**cur).is_shared()) {
+      /* node is shared with a snapshot, copy before modifying the path */
+      *cur = copy_on_write(*cur);
+    }
+
     /* number of bytes of the current node's prefix that match the key */
     prefix_match_len = (**cur).check_prefix(key + depth, key_len - depth);
 
@@ -159,6 +549,7 @@ T art<T>::set(const char *key, T value) {
       auto cur_leaf = static_cast<leaf_node<T>*>(*cur);
       T old_value = cur_leaf->value_;
       cur_leaf->value_ = value;
+      Counters::add(counter::set_replace);
       return old_value;
     }
 
@@ -179,7 +570,7 @@ T art<T>::set(const char *key, T value) {
        *                        /|\      /|\
        */
 
-      auto new_parent = new node_4<T>();
+      auto new_parent = Ladder::template make_smallest<T>();
       new_parent->prefix_ = new char[prefix_match_len];
       std::copy((**cur).prefix_, (**cur).prefix_ + prefix_match_len,
                 new_parent->prefix_);
@@ -198,6 +589,7 @@ T art<T>::set(const char *key, T value) {
       std::copy(old_prefix + prefix_match_len + 1, old_prefix + old_prefix_len,
                 (**cur).prefix_);
       delete[] old_prefix;
+      stats_.prefix_bytes_ -= prefix_match_len + 1;
 
       auto new_node = new leaf_node<T>(value);
       new_node->prefix_ = new char[key_len - depth - prefix_match_len - 1];
@@ -205,6 +597,9 @@ T art<T>::set(const char *key, T value) {
                 new_node->prefix_);
       new_node->prefix_len_ = key_len - depth - prefix_match_len - 1;
       new_parent->set_child(key[depth + prefix_match_len], new_node);
+      count_node(new_parent, 1);
+      count_node(new_node, 1);
+      Counters::add(counter::set_split);
 
       *cur = new_parent;
       return T{};
@@ -228,7 +623,10 @@ T art<T>::set(const char *key, T value) {
        */
 
       if ((**cur_inner).is_full()) {
-        *cur_inner = (**cur_inner).grow();
+        count_node(*cur_inner, -1);
+        *cur_inner = Ladder::grow(*cur_inner);
+        count_node(*cur_inner, 1);
+        Counters::add(counter::set_grow);
       }
 
       auto new_node = new leaf_node<T>(value);
@@ -237,6 +635,9 @@ T art<T>::set(const char *key, T value) {
                 new_node->prefix_);
       new_node->prefix_len_ = key_len - depth - (**cur).prefix_len_ - 1;
       (**cur_inner).set_child(child_partial_key, new_node);
+      ++stats_[(**cur).type()].children_;
+      count_node(new_node, 1);
+      Counters::add(counter::set_new_child);
       return T{};
     }
 
@@ -253,11 +654,12 @@ T art<T>::set(const char *key, T value) {
   }
 }
 
-template <class T> 
-T art<T>::del(const char *key) {
+template <class T, class Counters, class Shrink, class Ladder> 
+T art<T, Counters, Shrink, Ladder>::del(const char *key) {
   int depth = 0, key_len = std::strlen(key) + 1;
 
   if (root_ == nullptr) {
+    Counters::add(counter::del_miss);
     return T{};
   }
 
@@ -269,16 +671,18 @@ T art<T>::del(const char *key) {
   char cur_partial_key = 0;
 
   while (cur != nullptr) {
+    Counters::add(counter::nodes_visited);
     if ((**cur).prefix_len_ !=
         (**cur).check_prefix(key + depth, key_len - depth)) {
       /* prefix mismatch => key doesn't exist */
-
+      Counters::add(counter::del_miss);
       return T{};
     }
 
     if (key_len == depth + (**cur).prefix_len_) {
       /* exact match */
       if (!(**cur).is_leaf()) {
+        Counters::add(counter::del_miss);
         return T{};
       }
       auto value = static_cast<leaf_node<T>*>(*cur)->value_;
@@ -296,11 +700,10 @@ T art<T>::del(const char *key) {
          *   *(aa)->v2
          */
 
-        if ((**cur).prefix_ != nullptr) {
-          delete[](**cur).prefix_;
-        }
-        delete (*cur);
+        count_node(*cur, -1);
+        release(*cur);
         *cur = nullptr;
+        Counters::add(counter::del_root);
 
       } else if (n_siblings == 1) {
         /* => delete leaf node
@@ -316,11 +719,15 @@ T art<T>::del(const char *key) {
          */
 
         /* find sibling */
-        auto sibling_partial_key = (**par).next_partial_key(0);
+        auto sibling_partial_key = (**par).next_partial_key(-128);
         if (sibling_partial_key == cur_partial_key) {
           sibling_partial_key = (**par).next_partial_key(cur_partial_key + 1);
         }
-        auto sibling = *(**par).find_child(sibling_partial_key);
+        auto sibling_ptr = (**par).find_child(sibling_partial_key);
+        if ((**sibling_ptr).is_shared()) {
+          *sibling_ptr = copy_on_write(*sibling_ptr);
+        }
+        auto sibling = *sibling_ptr;
 
         auto old_prefix = sibling->prefix_;
         auto old_prefix_len = sibling->prefix_len_;
@@ -335,10 +742,10 @@ T art<T>::del(const char *key) {
         if (old_prefix != nullptr) {
           delete[] old_prefix;
         }
-        if ((**cur).prefix_ != nullptr) {
-          delete[](**cur).prefix_;
-        }
-        delete (*cur);
+        stats_.prefix_bytes_ += (**par).prefix_len_ + 1;
+        count_node(*cur, -1);
+        count_node(*par, -1);
+        release(*cur);
         if ((**par).prefix_ != nullptr) {
           delete[](**par).prefix_;
         }
@@ -346,6 +753,7 @@ T art<T>::del(const char *key) {
 
         /* this looks crazy, but I know what I'm doing */
         *par = static_cast<inner_node<T>*>(sibling);
+        Counters::add(counter::del_merge);
 
       } else /* if (n_siblings > 1) */ {
         /* => delete leaf node
@@ -358,13 +766,17 @@ T art<T>::del(const char *key) {
          *           *()->v1
          */
 
-        if ((**cur).prefix_ != nullptr) {
-          delete[](**cur).prefix_;
-        }
-        delete (*cur);
+        count_node(*cur, -1);
+        release(*cur);
         (**par).del_child(cur_partial_key);
-        if ((**par).is_underfull()) {
-          *par = (**par).shrink();
+        --stats_[(**par).type()].children_;
+        Counters::add(counter::del_child);
+        if (Shrink::should_shrink((**par).type(), (**par).n_children(),
+                                  Ladder::smaller_capacity((**par).type()))) {
+          count_node(*par, -1);
+          *par = Ladder::shrink(*par);
+          count_node(*par, 1);
+          Counters::add(counter::del_shrink);
         }
       }
 
@@ -372,26 +784,194 @@ T art<T>::del(const char *key) {
     }
 
     /* propagate down and repeat */
+    if ((**cur).is_shared()) {
+      /* node is shared with a snapshot, copy before modifying the path */
+      *cur = copy_on_write(*cur);
+    }
     cur_partial_key = key[depth + (**cur).prefix_len_];
     depth += (**cur).prefix_len_ + 1;
     par = reinterpret_cast<inner_node<T>**>(cur);
     cur = (**par).find_child(cur_partial_key);
   }
+  Counters::add(counter::del_miss);
   return T{};
 }
 
-template <class T> tree_it<T> art<T>::begin() {
+template <class T, class Counters, class Shrink, class Ladder>
+template <class Codec>
+void art<T, Counters, Shrink, Ladder>::save(std::ostream &out, Codec codec) const {
+  write_le<uint32_t>(out, SERIALIZATION_MAGIC);
+  write_le<uint32_t>(out, SERIALIZATION_VERSION);
+  write_le<uint8_t>(out, root_ != nullptr);
+
+  /* pre-order traversal, children in ascending partial key order */
+  std::stack<std::pair<char, node<T> *>> node_stack;
+  if (root_ != nullptr) {
+    node_stack.push(std::make_pair(0, root_));
+  }
+  node<T> *cur;
+  inner_node<T> *cur_inner;
+  while (!node_stack.empty()) {
+    cur = node_stack.top().second;
+    if (cur != root_) {
+      write_le<uint8_t>(out, node_stack.top().first);
+    }
+    node_stack.pop();
+    write_le<uint8_t>(out, static_cast<uint8_t>(cur->type()));
+    write_le<uint16_t>(out, cur->prefix_len_);
+    out.write(cur->prefix_, cur->prefix_len_);
+    if (cur->is_leaf()) {
+      codec.encode(out, static_cast<leaf_node<T> *>(cur)->value_);
+      continue;
+    }
+    cur_inner = static_cast<inner_node<T> *>(cur);
+    write_le<uint16_t>(out, cur_inner->n_children());
+    for (auto it = cur_inner->rbegin(), it_end = cur_inner->rend(); it != it_end;
+         ++it) {
+      node_stack.push(std::make_pair(*it, *cur_inner->find_child(*it)));
+    }
+  }
+  write_le<uint32_t>(out, SERIALIZATION_MAGIC);
+  if (!out) {
+    throw std::runtime_error("failed to write tree");
+  }
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+template <class Codec>
+void art<T, Counters, Shrink, Ladder>::load(std::istream &in, Codec codec) {
+  if (read_le<uint32_t>(in) != SERIALIZATION_MAGIC) {
+    throw std::runtime_error("not a serialized tree");
+  }
+  if (read_le<uint32_t>(in) != SERIALIZATION_VERSION) {
+    throw std::runtime_error("unsupported serialization version");
+  }
+  bool has_root = read_le<uint8_t>(in) != 0;
+
+  /* inner nodes whose children are not yet read, and their missing children */
+  std::stack<std::pair<inner_node<T> *, int>> node_stack;
+  node<T> *root = nullptr, *cur;
+  ::art::memory_stats stats;
+  int n_children, capacity;
+  char partial_key = 0;
+
+  try {
+    while (has_root) {
+      if (root != nullptr) {
+        while (!node_stack.empty() && node_stack.top().second == 0) {
+          node_stack.pop();
+        }
+        if (node_stack.empty()) {
+          break;
+        }
+        partial_key = static_cast<char>(read_le<uint8_t>(in));
+        if (node_stack.top().first->find_child(partial_key) != nullptr) {
+          throw std::runtime_error("duplicate partial key");
+        }
+      }
+
+      auto type = static_cast<node_type>(read_le<uint8_t>(in));
+      uint16_t prefix_len = read_le<uint16_t>(in);
+      char *prefix = prefix_len > 0 ? new char[prefix_len] : nullptr;
+      if (!in.read(prefix, prefix_len)) {
+        delete[] prefix;
+        throw std::runtime_error("unexpected end of stream");
+      }
+
+      switch (type) {
+      case node_type::leaf:
+        try {
+          cur = new leaf_node<T>(codec.decode(in));
+        } catch (...) {
+          delete[] prefix;
+          throw;
+        }
+        break;
+      case node_type::node_4:
+      case node_type::node_8:
+      case node_type::node_16:
+      case node_type::node_48:
+      case node_type::node_256:
+        /* a node of a class the ladder lacks becomes a node of the smallest
+         * class holding its children */
+        n_children = read_le<uint16_t>(in);
+        capacity = type == node_type::node_4    ? 4
+                   : type == node_type::node_8  ? 8
+                   : type == node_type::node_16 ? 16
+                   : type == node_type::node_48 ? 48
+                                                : 256;
+        if (n_children == 0 || n_children > capacity) {
+          delete[] prefix;
+          throw std::runtime_error("invalid number of children");
+        }
+        cur = Ladder::template make<T>(type, n_children);
+        break;
+      default:
+        delete[] prefix;
+        throw std::runtime_error("invalid node type");
+      }
+      cur->prefix_ = prefix;
+      cur->prefix_len_ = prefix_len;
+      ++stats[cur->type()].count_;
+      stats.prefix_bytes_ += prefix_len;
+
+      if (root == nullptr) {
+        root = cur;
+      } else {
+        node_stack.top().first->set_child(partial_key, cur);
+        --node_stack.top().second;
+        ++stats[node_stack.top().first->type()].children_;
+      }
+
+      if (!cur->is_leaf()) {
+        node_stack.push(std::make_pair(static_cast<inner_node<T> *>(cur),
+                                       n_children));
+      }
+    }
+    if (read_le<uint32_t>(in) != SERIALIZATION_MAGIC) {
+      throw std::runtime_error("corrupt serialized tree");
+    }
+  } catch (...) {
+    release(root);
+    throw;
+  }
+
+  release(root_);
+  root_ = root;
+  stats_ = stats;
+}
+
+template <class T, class Counters, class Shrink, class Ladder> tree_it<T> art<T, Counters, Shrink, Ladder>::begin() {
   return tree_it<T>::min(this->root_);
 }
 
-template <class T> tree_it<T> art<T>::begin(const char *key) {
+template <class T, class Counters, class Shrink, class Ladder>
+tree_it<T> art<T, Counters, Shrink, Ladder>::begin(const char *key) {
   return tree_it<T>::greater_equal(this->root_, key);
 }
 
-template <class T> tree_it<T> art<T>::end() { 
+template <class T, class Counters, class Shrink, class Ladder> tree_it<T> art<T, Counters, Shrink, Ladder>::begin() const {
+  return tree_it<T>::min(this->root_);
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+tree_it<T> art<T, Counters, Shrink, Ladder>::begin(const char *key) const {
+  return tree_it<T>::greater_equal(this->root_, key);
+}
+
+template <class T, class Counters, class Shrink, class Ladder> tree_it<T> art<T, Counters, Shrink, Ladder>::end() { 
   return tree_it<T>(); 
 }
 
+template <class T, class Counters, class Shrink, class Ladder> tree_it<T> art<T, Counters, Shrink, Ladder>::end() const {
+  return tree_it<T>();
+}
+
+template <class T, class Counters, class Shrink, class Ladder>
+frozen_art<T> art<T, Counters, Shrink, Ladder>::freeze() const {
+  return frozen_art<T>(root_);
+}
+
 } // namespace art
 
 #endif
@@ -0,0 +1,25 @@
+/**
+ * @file adaptive radix tree forward declaration
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_ART_FWD_HPP
+#define ART_ART_FWD_HPP
+
+#include "counters.hpp"
+#include "node_ladder.hpp"
+#include "shrink_policy.hpp"
+
+namespace art {
+
+/**
+ * Trees count nothing unless a counters policy is given, shrink with
+ * hysteresis and use the default node ladder.
+ */
+template <class T, class Counters = no_counters,
+          class Shrink = hysteresis_shrink, class Ladder = default_ladder>
+class art;
+
+} // namespace art
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * @file ordered string set header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_ART_SET_HPP
+#define ART_ART_SET_HPP
+
+#include "art.hpp"
+#include "leaf_node.hpp"
+#include "memory_stats.hpp"
+#include "structure_stats.hpp"
+#include "tree_it.hpp"
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace art {
+
+/**
+ * Ordered set of strings, i.e., an adaptive radix tree without values.
+ * Leaves store only the last bytes of their key, a leaf is 24 bytes instead
+ * of the 32 bytes of an art<int *> leaf, and inserts copy no value.
+ *
+ * @tparam Counters - See art.
+ * @tparam Shrink - See art.
+ * @tparam Ladder - See art.
+ */
+template <class Counters, class Shrink, class Ladder>
+class art<void, Counters, Shrink, Ladder> {
+public:
+  class iterator;
+
+  art() = default;
+
+  /**
+   * Takes a snapshot of the set in O(1), see art::snapshot.
+   */
+  art<void, Counters, Shrink, Ladder> snapshot() const;
+
+  /**
+   * Adds the given key to the set.
+   *
+   * @param key - The key to add.
+   * @return true if the key was not in the set.
+   */
+  bool insert(const char *key);
+
+  /**
+   * Determines if the given key is in the set.
+   */
+  bool contains(const char *key) const;
+
+  /**
+   * Removes the given key from the set.
+   *
+   * @param key - The key to remove.
+   * @return true if the key was in the set.
+   */
+  bool erase(const char *key);
+
+  /**
+   * Number of keys in the set, O(1).
+   */
+  uint64_t size() const;
+
+  /**
+   * Forward iterator over the keys in lexicographic order.
+   */
+  iterator begin() const;
+
+  /**
+   * Forward iterator over the keys in lexicographic order starting from the
+   * provided key.
+   */
+  iterator begin(const char *key) const;
+
+  iterator end() const;
+
+  /**
+   * Writes the set, see art::save. No value bytes are written.
+   */
+  void save(std::ostream &out) const;
+
+  /**
+   * Replaces the set's contents with a set written by save, see art::load.
+   */
+  void load(std::istream &in);
+
+  ::art::memory_stats memory_stats() const;
+  ::art::structure_stats structure_stats() const;
+
+private:
+  /**
+   * Codec of save and load, which writes nothing.
+   */
+  struct no_value_codec {
+    void encode(std::ostream &, const no_value &) const {}
+    no_value decode(std::istream &) const { return no_value(); }
+  };
+
+  art<no_value, Counters, Shrink, Ladder> tree_;
+};
+
+/**
+ * Iterates the keys of a set, dereferencing yields the key.
+ */
+template <class Counters, class Shrink, class Ladder>
+class art<void, Counters, Shrink, Ladder>::iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = std::string;
+  using difference_type = int;
+  using pointer = const value_type *;
+  using reference = value_type;
+
+  iterator() = default;
+  explicit iterator(tree_it<no_value> it);
+
+  reference operator*() const;
+  iterator &operator++();
+  iterator operator++(int);
+  bool operator==(const iterator &rhs) const;
+  bool operator!=(const iterator &rhs) const;
+
+  /**
+   * Copies the key to the output iterator without allocating a string.
+   */
+  template <class OutputIt> void key(OutputIt key) const;
+  int get_key_len() const;
+
+private:
+  tree_it<no_value> it_;
+};
+
+template <class Counters, class Shrink, class Ladder>
+art<void, Counters, Shrink, Ladder>
+art<void, Counters, Shrink, Ladder>::snapshot() const {
+  return *this;
+}
+
+template <class Counters, class Shrink, class Ladder>
+bool art<void, Counters, Shrink, Ladder>::insert(const char *key) {
+  uint64_t n_keys = tree_.stats_.n_keys();
+  tree_.set(key, no_value());
+  return tree_.stats_.n_keys() != n_keys;
+}
+
+template <class Counters, class Shrink, class Ladder>
+bool art<void, Counters, Shrink, Ladder>::contains(const char *key) const {
+  return tree_.contains(key);
+}
+
+template <class Counters, class Shrink, class Ladder>
+bool art<void, Counters, Shrink, Ladder>::erase(const char *key) {
+  uint64_t n_keys = tree_.stats_.n_keys();
+  tree_.del(key);
+  return tree_.stats_.n_keys() != n_keys;
+}
+
+template <class Counters, class Shrink, class Ladder>
+uint64_t art<void, Counters, Shrink, Ladder>::size() const {
+  return tree_.stats_.n_keys();
+}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator
+art<void, Counters, Shrink, Ladder>::begin() const {
+  return iterator(tree_.begin());
+}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator
+art<void, Counters, Shrink, Ladder>::begin(const char *key) const {
+  return iterator(tree_.begin(key));
+}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator
+art<void, Counters, Shrink, Ladder>::end() const {
+  return iterator(tree_.end());
+}
+
+template <class Counters, class Shrink, class Ladder>
+void art<void, Counters, Shrink, Ladder>::save(std::ostream &out) const {
+  tree_.save(out, no_value_codec());
+}
+
+template <class Counters, class Shrink, class Ladder>
+void art<void, Counters, Shrink, Ladder>::load(std::istream &in) {
+  tree_.load(in, no_value_codec());
+}
+
+template <class Counters, class Shrink, class Ladder>
+::art::memory_stats art<void, Counters, Shrink, Ladder>::memory_stats() const {
+  return tree_.memory_stats();
+}
+
+template <class Counters, class Shrink, class Ladder>
+::art::structure_stats
+art<void, Counters, Shrink, Ladder>::structure_stats() const {
+  return tree_.structure_stats();
+}
+
+template <class Counters, class Shrink, class Ladder>
+art<void, Counters, Shrink, Ladder>::iterator::iterator(tree_it<no_value> it)
+    : it_(std::move(it)) {}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator::reference
+art<void, Counters, Shrink, Ladder>::iterator::operator*() const {
+  return it_.key();
+}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator &
+art<void, Counters, Shrink, Ladder>::iterator::operator++() {
+  ++it_;
+  return *this;
+}
+
+template <class Counters, class Shrink, class Ladder>
+typename art<void, Counters, Shrink, Ladder>::iterator
+art<void, Counters, Shrink, Ladder>::iterator::operator++(int) {
+  auto old = *this;
+  ++it_;
+  return old;
+}
+
+template <class Counters, class Shrink, class Ladder>
+bool art<void, Counters, Shrink, Ladder>::iterator::operator==(
+    const iterator &rhs) const {
+  return it_ == rhs.it_;
+}
+
+template <class Counters, class Shrink, class Ladder>
+bool art<void, Counters, Shrink, Ladder>::iterator::operator!=(
+    const iterator &rhs) const {
+  return it_ != rhs.it_;
+}
+
+template <class Counters, class Shrink, class Ladder>
+template <class OutputIt>
+void art<void, Counters, Shrink, Ladder>::iterator::key(OutputIt key) const {
+  it_.key(key);
+}
+
+template <class Counters, class Shrink, class Ladder>
+int art<void, Counters, Shrink, Ladder>::iterator::get_key_len() const {
+  return it_.get_key_len();
+}
+
+} // namespace art
+
+#endif
@@ -6,11 +6,13 @@
 #ifndef ART_CHILD_IT_HPP
 #define ART_CHILD_IT_HPP
 
+#include <cassert>
 #include <iterator>
 
 namespace art {
 
 template <class T> class inner_node;
+template <class T> class node;
 
 template <class T> class child_it {
 public:
@@ -0,0 +1,189 @@
+/**
+ * @file operation counters header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_COUNTERS_HPP
+#define ART_COUNTERS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace art {
+
+/**
+ * Code paths of art::get, art::set and art::del which are counted by a
+ * counters policy.
+ */
+enum class counter : unsigned {
+  get_hit,
+  get_miss,
+  set_root,      // insert into an empty tree
+  set_replace,   // exact match, value replaced
+  set_split,     // prefix mismatch, new parent node
+  set_new_child, // new leaf below an existing inner node
+  set_grow,      // inner node grown before adding a child
+  del_miss,
+  del_root,      // deleted the root leaf
+  del_merge,     // parent replaced by the only sibling
+  del_child,     // child removed from the parent
+  del_shrink,    // parent shrunk after removing a child
+  nodes_visited, // nodes visited by get, set and del
+  n_counters
+};
+
+/**
+ * Counters policy which counts nothing, every call compiles to nothing.
+ */
+struct no_counters {
+  static void add(counter, uint64_t = 1) {}
+};
+
+/**
+ * Counts of all counters.
+ */
+struct counter_values {
+  uint64_t values_[static_cast<unsigned>(counter::n_counters)] = {};
+
+  uint64_t operator[](counter c) const {
+    return values_[static_cast<unsigned>(c)];
+  }
+
+  /**
+   * Number of get, set and del operations.
+   */
+  uint64_t n_operations() const;
+
+  /**
+   * Average number of nodes visited per operation.
+   */
+  double nodes_per_operation() const;
+};
+
+inline uint64_t counter_values::n_operations() const {
+  uint64_t n = 0;
+  for (unsigned c = 0; c < static_cast<unsigned>(counter::nodes_visited); ++c) {
+    /* set_grow accompanies set_new_child, del_shrink accompanies del_child */
+    if (c != static_cast<unsigned>(counter::set_grow) &&
+        c != static_cast<unsigned>(counter::del_shrink)) {
+      n += values_[c];
+    }
+  }
+  return n;
+}
+
+inline double counter_values::nodes_per_operation() const {
+  uint64_t n = n_operations();
+  return n > 0 ? static_cast<double>((*this)[counter::nodes_visited]) / n : 0;
+}
+
+/**
+ * Counters policy with one block of counters per thread, so counting never
+ * contends. A thread's counters are only written by the thread itself, with
+ * relaxed atomics, and are summed up by read. Counters of exited threads are
+ * retained.
+ * The counts are shared by all trees using this policy.
+ */
+class thread_counters {
+public:
+  static void add(counter c, uint64_t n = 1);
+
+  /**
+   * Sums up the counters of all threads.
+   */
+  static counter_values read();
+
+  /**
+   * Zeroes the counters of all threads.
+   * Increments concurrent to the reset may be lost.
+   */
+  static void reset();
+
+private:
+  static const unsigned N = static_cast<unsigned>(counter::n_counters);
+
+  struct block {
+    block();
+    ~block();
+
+    std::atomic<uint64_t> values_[N];
+  };
+
+  struct registry {
+    std::mutex mutex_;
+    std::vector<block *> blocks_;
+    counter_values retired_;
+  };
+
+  static registry &get_registry();
+  static block &get_block();
+};
+
+inline thread_counters::block::block() {
+  for (auto &value : values_) {
+    value.store(0, std::memory_order_relaxed);
+  }
+  registry &r = get_registry();
+  std::lock_guard<std::mutex> lock(r.mutex_);
+  r.blocks_.push_back(this);
+}
+
+inline thread_counters::block::~block() {
+  registry &r = get_registry();
+  std::lock_guard<std::mutex> lock(r.mutex_);
+  for (unsigned c = 0; c < N; ++c) {
+    r.retired_.values_[c] += values_[c].load(std::memory_order_relaxed);
+  }
+  for (auto it = r.blocks_.begin(); it != r.blocks_.end(); ++it) {
+    if (*it == this) {
+      r.blocks_.erase(it);
+      break;
+    }
+  }
+}
+
+inline thread_counters::registry &thread_counters::get_registry() {
+  static registry r;
+  return r;
+}
+
+inline thread_counters::block &thread_counters::get_block() {
+  static thread_local block b;
+  return b;
+}
+
+inline void thread_counters::add(counter c, uint64_t n) {
+  /* single writer, no atomic read-modify-write needed */
+  auto &value = get_block().values_[static_cast<unsigned>(c)];
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+
+inline counter_values thread_counters::read() {
+  registry &r = get_registry();
+  std::lock_guard<std::mutex> lock(r.mutex_);
+  counter_values values = r.retired_;
+  for (block *b : r.blocks_) {
+    for (unsigned c = 0; c < N; ++c) {
+      values.values_[c] += b->values_[c].load(std::memory_order_relaxed);
+    }
+  }
+  return values;
+}
+
+inline void thread_counters::reset() {
+  registry &r = get_registry();
+  std::lock_guard<std::mutex> lock(r.mutex_);
+  r.retired_ = counter_values();
+  for (block *b : r.blocks_) {
+    for (auto &value : b->values_) {
+      value.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace art
+
+#endif
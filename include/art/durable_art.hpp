@@ -0,0 +1,513 @@
+/**
+ * @file durable tree header, write-ahead log and checkpoints
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_DURABLE_ART_HPP
+#define ART_DURABLE_ART_HPP
+
+#include "art.hpp"
+#include "serialization.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace art {
+
+/**
+ * Preallocated ring buffer holding log records which are not yet written to
+ * the log file. Positions are absolute byte counts since the log was opened.
+ */
+class log_buffer : public std::streambuf {
+public:
+  explicit log_buffer(size_t capacity);
+
+  /**
+   * Sets the file descriptor the buffer is flushed to and the current length
+   * of the file. The buffer must be empty.
+   */
+  void set_fd(int fd, uint64_t file_size);
+
+  /**
+   * Starts a new record, the record must be ended before the next one starts.
+   * Reserves space for the record header.
+   */
+  void begin_record();
+
+  /**
+   * Ends the current record and fills in its header, i.e., the payload length
+   * and checksum.
+   */
+  void end_record();
+
+  /**
+   * Discards the current record.
+   */
+  void abort_record();
+
+  /**
+   * Writes all complete records to the file.
+   *
+   * @throws std::runtime_error if writing fails.
+   */
+  void flush();
+
+  /**
+   * Number of bytes not yet written to the file.
+   */
+  size_t size() const;
+
+  /**
+   * Length of the file, excluding buffered bytes.
+   */
+  uint64_t file_size() const;
+
+  void write(const char *bytes, size_t n);
+
+  static uint32_t crc32(const char *bytes, size_t n, uint32_t crc = 0);
+
+  static const size_t HEADER_LEN = 8;
+
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char *s, std::streamsize n) override;
+
+private:
+  void flush(uint64_t until);
+  char &at(uint64_t pos);
+
+  std::vector<char> buf_;
+  int fd_ = -1;
+  uint64_t head_ = 0; // first byte not yet written to the file, file offset
+  uint64_t mark_ = 0; // first byte of the current record
+  uint64_t tail_ = 0; // first free byte
+};
+
+inline log_buffer::log_buffer(size_t capacity) : buf_(capacity) {}
+
+inline void log_buffer::set_fd(int fd, uint64_t file_size) {
+  assert(size() == 0);
+  fd_ = fd;
+  head_ = mark_ = tail_ = file_size;
+}
+
+inline char &log_buffer::at(uint64_t pos) { return buf_[pos % buf_.size()]; }
+
+inline void log_buffer::write(const char *bytes, size_t n) {
+  while (n > 0) {
+    if (tail_ - head_ == buf_.size()) {
+      if (mark_ == head_) {
+        throw std::length_error("log record exceeds log buffer");
+      }
+      /* make room by writing the complete records */
+      flush(mark_);
+    }
+    size_t pos = tail_ % buf_.size();
+    size_t len = std::min<size_t>(
+        n, std::min<size_t>(buf_.size() - pos, buf_.size() - (tail_ - head_)));
+    std::memcpy(&buf_[pos], bytes, len);
+    tail_ += len;
+    bytes += len;
+    n -= len;
+  }
+}
+
+inline void log_buffer::begin_record() {
+  mark_ = tail_;
+  char header[HEADER_LEN] = {};
+  write(header, HEADER_LEN);
+}
+
+inline void log_buffer::end_record() {
+  uint32_t len = tail_ - mark_ - HEADER_LEN, crc = 0;
+  for (uint64_t pos = mark_ + HEADER_LEN; pos < tail_;) {
+    size_t offset = pos % buf_.size();
+    size_t n = std::min<uint64_t>(tail_ - pos, buf_.size() - offset);
+    crc = crc32(&buf_[offset], n, crc);
+    pos += n;
+  }
+  for (unsigned i = 0; i < 4; ++i) {
+    at(mark_ + i) = static_cast<char>(len >> (8 * i));
+    at(mark_ + 4 + i) = static_cast<char>(crc >> (8 * i));
+  }
+  mark_ = tail_;
+}
+
+inline void log_buffer::abort_record() { tail_ = mark_; }
+
+inline void log_buffer::flush() { flush(mark_); }
+
+inline void log_buffer::flush(uint64_t until) {
+  while (head_ < until) {
+    size_t offset = head_ % buf_.size();
+    size_t n = std::min<uint64_t>(until - head_, buf_.size() - offset);
+    ssize_t written = ::write(fd_, &buf_[offset], n);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("failed to write log: ") +
+                               std::strerror(errno));
+    }
+    head_ += written;
+  }
+}
+
+inline size_t log_buffer::size() const { return tail_ - head_; }
+
+inline uint64_t log_buffer::file_size() const { return head_; }
+
+inline log_buffer::int_type log_buffer::overflow(int_type c) {
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    char ch = traits_type::to_char_type(c);
+    write(&ch, 1);
+  }
+  return traits_type::not_eof(c);
+}
+
+inline std::streamsize log_buffer::xsputn(const char *s, std::streamsize n) {
+  write(s, n);
+  return n;
+}
+
+inline uint32_t log_buffer::crc32(const char *bytes, size_t n, uint32_t crc) {
+  struct table {
+    uint32_t entries_[256];
+    table() {
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+          c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        }
+        entries_[i] = c;
+      }
+    }
+  };
+  static const table t;
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc = t.entries_[(crc ^ static_cast<uint8_t>(bytes[i])) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/**
+ * Tree whose writes are durable.
+ * Every set/del appends a record to a write-ahead log in the given directory.
+ * Records are collected in a preallocated ring buffer and written to the log
+ * with one system call per group commit. Checkpoints write the whole tree
+ * with art::save and truncate the log. On construction, the last checkpoint
+ * is loaded and the log tail is replayed, a torn record at the end of the log
+ * is discarded.
+ *
+ * Replaying records which are already part of the checkpoint (crash between
+ * checkpoint and log truncation) is harmless, since each key's final value
+ * only depends on the last record touching it.
+ */
+template <class T, class Codec = pod_codec<T>> class durable_art {
+public:
+  struct options {
+    /* capacity of the ring buffer holding uncommitted log records */
+    size_t buffer_size = 1 << 20;
+
+    /* commits once this many bytes are buffered, 0 commits only explicitly */
+    size_t group_commit_size = 64 << 10;
+
+    /* fsyncs the log every n commits, 0 leaves syncing to the OS */
+    int sync_interval = 1;
+
+    /* checkpoints once the log exceeds this many bytes, 0 disables */
+    uint64_t checkpoint_size = 0;
+  };
+
+  /**
+   * Opens or creates the durable tree in the given directory, recovering the
+   * state of the last commit.
+   *
+   * @param dir - Existing directory holding the checkpoint and log files.
+   * @throws std::runtime_error if the files cannot be opened or read.
+   */
+  explicit durable_art(const std::string &dir, options opts = options(),
+                       Codec codec = Codec());
+
+  durable_art(const durable_art &other) = delete;
+  durable_art &operator=(const durable_art &other) = delete;
+
+  /**
+   * Commits all buffered records.
+   */
+  ~durable_art();
+
+  /**
+   * Finds the value associated with the given key.
+   */
+  T get(const char *key) const;
+
+  /**
+   * Associates the given key with the given value, see art::set.
+   * The write is durable after the next commit.
+   */
+  T set(const char *key, T value);
+
+  /**
+   * Deletes the given key, see art::del.
+   * The write is durable after the next commit.
+   */
+  T del(const char *key);
+
+  /**
+   * Writes all buffered records to the log and fsyncs it according to
+   * options::sync_interval. Checkpoints if the log exceeds
+   * options::checkpoint_size.
+   */
+  void commit();
+
+  /**
+   * Writes the whole tree to a new checkpoint and truncates the log.
+   */
+  void checkpoint();
+
+  /**
+   * The in-memory tree, e.g., for iteration.
+   */
+  const art<T> &tree() const;
+
+private:
+  enum class op : uint8_t { set = 1, del = 2 };
+
+  void recover();
+  uint64_t replay(std::istream &in);
+  void append(op o, const char *key, const T *value);
+  void maybe_commit();
+  void sync(int fd, const char *what);
+
+  std::string checkpoint_path() const;
+  std::string log_path() const;
+
+  std::string dir_;
+  options opts_;
+  Codec codec_;
+  art<T> tree_;
+  log_buffer buffer_;
+  std::ostream record_stream_;
+  int log_fd_ = -1;
+  int n_unsynced_commits_ = 0;
+};
+
+template <class T, class Codec>
+durable_art<T, Codec>::durable_art(const std::string &dir, options opts,
+                                   Codec codec)
+    : dir_(dir), opts_(opts), codec_(codec), buffer_(opts.buffer_size),
+      record_stream_(&buffer_) {
+  record_stream_.exceptions(std::ios::badbit);
+  recover();
+}
+
+template <class T, class Codec> durable_art<T, Codec>::~durable_art() {
+  try {
+    commit();
+  } catch (...) {
+    /* destructor must not throw, uncommitted records are lost */
+  }
+  ::close(log_fd_);
+}
+
+template <class T, class Codec>
+std::string durable_art<T, Codec>::checkpoint_path() const {
+  return dir_ + "/checkpoint";
+}
+
+template <class T, class Codec>
+std::string durable_art<T, Codec>::log_path() const {
+  return dir_ + "/wal";
+}
+
+template <class T, class Codec> void durable_art<T, Codec>::recover() {
+  std::ifstream checkpoint_in(checkpoint_path(), std::ios::binary);
+  if (checkpoint_in) {
+    tree_.load(checkpoint_in, codec_);
+  }
+
+  uint64_t log_len = 0;
+  std::ifstream log_in(log_path(), std::ios::binary);
+  if (log_in) {
+    log_len = replay(log_in);
+  }
+
+  log_fd_ = ::open(log_path().c_str(), O_WRONLY | O_CREAT, 0644);
+  if (log_fd_ < 0) {
+    throw std::runtime_error("cannot open log " + log_path() + ": " +
+                             std::strerror(errno));
+  }
+  /* discard a torn record at the end of the log */
+  if (ftruncate(log_fd_, log_len) != 0 ||
+      lseek(log_fd_, log_len, SEEK_SET) < 0) {
+    ::close(log_fd_);
+    throw std::runtime_error("cannot truncate log " + log_path() + ": " +
+                             std::strerror(errno));
+  }
+  buffer_.set_fd(log_fd_, log_len);
+}
+
+template <class T, class Codec>
+uint64_t durable_art<T, Codec>::replay(std::istream &in) {
+  in.seekg(0, std::ios::end);
+  uint64_t file_len = in.tellg(), log_len = 0;
+  in.seekg(0);
+  char header[log_buffer::HEADER_LEN];
+  std::string payload, key;
+  while (in.read(header, log_buffer::HEADER_LEN)) {
+    std::istringstream header_in(std::string(header, log_buffer::HEADER_LEN));
+    uint32_t len = read_le<uint32_t>(header_in);
+    uint32_t crc = read_le<uint32_t>(header_in);
+    if (len > file_len - log_len - log_buffer::HEADER_LEN) {
+      break;
+    }
+    payload.resize(len);
+    if (!in.read(&payload[0], len) ||
+        log_buffer::crc32(payload.data(), len) != crc) {
+      /* torn or corrupt record, the log ends here */
+      break;
+    }
+    std::istringstream record_in(payload);
+    auto o = static_cast<op>(read_le<uint8_t>(record_in));
+    key.resize(read_le<uint32_t>(record_in));
+    record_in.read(&key[0], key.size());
+    if (o == op::set) {
+      tree_.set(key.c_str(), codec_.decode(record_in));
+    } else {
+      tree_.del(key.c_str());
+    }
+    log_len += log_buffer::HEADER_LEN + len;
+  }
+  return log_len;
+}
+
+template <class T, class Codec>
+void durable_art<T, Codec>::append(op o, const char *key, const T *value) {
+  uint32_t key_len = std::strlen(key);
+  buffer_.begin_record();
+  try {
+    write_le<uint8_t>(record_stream_, static_cast<uint8_t>(o));
+    write_le<uint32_t>(record_stream_, key_len);
+    buffer_.write(key, key_len);
+    if (value != nullptr) {
+      codec_.encode(record_stream_, *value);
+    }
+  } catch (...) {
+    buffer_.abort_record();
+    record_stream_.clear();
+    throw;
+  }
+  buffer_.end_record();
+}
+
+template <class T, class Codec> void durable_art<T, Codec>::maybe_commit() {
+  if (opts_.group_commit_size != 0 &&
+      buffer_.size() >= opts_.group_commit_size) {
+    commit();
+  }
+}
+
+template <class T, class Codec>
+T durable_art<T, Codec>::get(const char *key) const {
+  return tree_.get(key);
+}
+
+template <class T, class Codec>
+T durable_art<T, Codec>::set(const char *key, T value) {
+  append(op::set, key, &value);
+  T old_value = tree_.set(key, value);
+  /* the tree must contain the record before a checkpoint truncates the log */
+  maybe_commit();
+  return old_value;
+}
+
+template <class T, class Codec> T durable_art<T, Codec>::del(const char *key) {
+  append(op::del, key, nullptr);
+  T old_value = tree_.del(key);
+  maybe_commit();
+  return old_value;
+}
+
+template <class T, class Codec>
+void durable_art<T, Codec>::sync(int fd, const char *what) {
+  if (fsync(fd) != 0) {
+    throw std::runtime_error(std::string("cannot sync ") + what + ": " +
+                             std::strerror(errno));
+  }
+}
+
+template <class T, class Codec> void durable_art<T, Codec>::commit() {
+  if (buffer_.size() == 0) {
+    return;
+  }
+  buffer_.flush();
+  if (opts_.sync_interval != 0 &&
+      ++n_unsynced_commits_ >= opts_.sync_interval) {
+    sync(log_fd_, "log");
+    n_unsynced_commits_ = 0;
+  }
+  if (opts_.checkpoint_size != 0 &&
+      buffer_.file_size() >= opts_.checkpoint_size) {
+    checkpoint();
+  }
+}
+
+template <class T, class Codec> void durable_art<T, Codec>::checkpoint() {
+  buffer_.flush();
+  sync(log_fd_, "log");
+  n_unsynced_commits_ = 0;
+
+  std::string tmp_path = checkpoint_path() + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    tree_.save(out, codec_);
+    out.flush();
+    if (!out) {
+      throw std::runtime_error("cannot write checkpoint " + tmp_path);
+    }
+  }
+  int fd = ::open(tmp_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open checkpoint " + tmp_path);
+  }
+  sync(fd, "checkpoint");
+  ::close(fd);
+  if (std::rename(tmp_path.c_str(), checkpoint_path().c_str()) != 0) {
+    throw std::runtime_error("cannot rename checkpoint " + tmp_path);
+  }
+  fd = ::open(dir_.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    ::close(fd);
+  }
+
+  /* the checkpoint contains all logged records */
+  if (ftruncate(log_fd_, 0) != 0 || lseek(log_fd_, 0, SEEK_SET) < 0) {
+    throw std::runtime_error("cannot truncate log " + log_path());
+  }
+  sync(log_fd_, "log");
+  buffer_.set_fd(log_fd_, 0);
+}
+
+template <class T, class Codec>
+const art<T> &durable_art<T, Codec>::tree() const {
+  return tree_;
+}
+
+} // namespace art
+
+#endif
@@ -0,0 +1,420 @@
+/**
+ * @file frozen (immutable, read-optimized) tree header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_FROZEN_ART_HPP
+#define ART_FROZEN_ART_HPP
+
+#include "art_fwd.hpp"
+#include "leaf_node.hpp"
+#include "inner_node.hpp"
+#include "node.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stack>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace art {
+
+/**
+ * Immutable tree produced by art::freeze.
+ * Nodes are sized exactly to their number of children and packed
+ * contiguously in depth-first order into a single array of 32 bit words,
+ * children are referenced by their word offset. All prefixes are pooled in
+ * a single byte array and values are stored in key order.
+ *
+ * Node layout (words):
+ *
+ *   prefix offset, prefix length | number of children << 16
+ *   leaf:   value index
+ *   inner:  sorted partial keys (padded to a word), child offsets
+ */
+template <class T> class frozen_art {
+public:
+  class iterator;
+
+  /**
+   * Creates an empty tree.
+   */
+  frozen_art() = default;
+
+  /**
+   * Finds the value associated with the given key.
+   *
+   * @param key - The key to find.
+   * @return the value associated with the key or a default constructed value.
+   */
+  T get(const char *key) const;
+
+  /**
+   * Number of keys in the tree.
+   */
+  size_t size() const;
+
+  /**
+   * Bytes used by nodes, prefixes and values.
+   */
+  size_t memory_usage() const;
+
+  /**
+   * Forward iterator that traverses the tree in lexicographic order.
+   */
+  iterator begin() const;
+
+  /**
+   * Forward iterator that traverses the tree in lexicographic order starting
+   * from the smallest key greater or equal than the provided key.
+   */
+  iterator begin(const char *key) const;
+
+  /**
+   * Iterator to the end of the lexicographic order.
+   */
+  iterator end() const;
+
+private:
+  template <class U, class Counters, class Shrink, class Ladder>
+  friend class art;
+
+  explicit frozen_art(const node<T> *root);
+
+  uint32_t prefix_len(uint32_t n) const;
+  uint32_t n_children(uint32_t n) const;
+  const char *prefix(uint32_t n) const;
+  const char *partial_keys(uint32_t n) const;
+  const uint32_t *children(uint32_t n) const;
+  uint32_t value_index(uint32_t n) const;
+
+  /**
+   * Index of the first child whose partial key is greater or equal than the
+   * given partial key, or the number of children if there is none.
+   */
+  uint32_t lower_child(uint32_t n, char partial_key) const;
+
+  std::vector<uint32_t> nodes_;
+  std::vector<char> prefix_pool_;
+  std::vector<T> values_;
+};
+
+template <class T> class frozen_art<T>::iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = int;
+  using pointer = const T *;
+  using reference = const T &;
+
+  iterator() = default;
+
+  reference operator*() const;
+  pointer operator->() const;
+  iterator &operator++();
+  iterator operator++(int);
+  bool operator==(const iterator &rhs) const;
+  bool operator!=(const iterator &rhs) const;
+
+  /**
+   * The key of the current entry.
+   */
+  const std::string key() const;
+
+private:
+  friend class frozen_art<T>;
+
+  static const uint32_t END = UINT32_MAX;
+
+  struct frame {
+    uint32_t node_;
+    uint32_t child_;
+    size_t key_len_;
+  };
+
+  explicit iterator(const frozen_art<T> *tree);
+
+  void push(uint32_t n, uint32_t child);
+  void seek_leaf(uint32_t n);
+  void seek_next();
+
+  const frozen_art<T> *tree_ = nullptr;
+  std::vector<frame> stack_;
+  std::string key_;
+  uint32_t value_ = END;
+};
+
+template <class T> frozen_art<T>::frozen_art(const node<T> *root) {
+  /* pre-order traversal, the slot referencing a node is patched when the
+   * node is placed */
+  std::stack<std::pair<const node<T> *, size_t>> node_stack;
+  if (root != nullptr) {
+    node_stack.push(std::make_pair(root, SIZE_MAX));
+  }
+  while (!node_stack.empty()) {
+    const node<T> *cur = node_stack.top().first;
+    size_t slot = node_stack.top().second;
+    node_stack.pop();
+    if (nodes_.size() > UINT32_MAX || prefix_pool_.size() > UINT32_MAX ||
+        values_.size() >= UINT32_MAX) {
+      throw std::length_error("tree too large to freeze");
+    }
+    uint32_t n = nodes_.size();
+    if (slot != SIZE_MAX) {
+      nodes_[slot] = n;
+    }
+    nodes_.push_back(prefix_pool_.size());
+    prefix_pool_.insert(prefix_pool_.end(), cur->prefix_,
+                        cur->prefix_ + cur->prefix_len_);
+    if (cur->is_leaf()) {
+      nodes_.push_back(cur->prefix_len_);
+      nodes_.push_back(values_.size());
+      values_.push_back(static_cast<const leaf_node<T> *>(cur)->value_);
+      continue;
+    }
+    auto cur_inner =
+        const_cast<inner_node<T> *>(static_cast<const inner_node<T> *>(cur));
+    uint32_t n_children = cur_inner->n_children();
+    nodes_.push_back(cur->prefix_len_ | n_children << 16);
+    size_t keys = nodes_.size();
+    nodes_.resize(keys + (n_children + 3) / 4 + n_children, 0);
+    char *keys_begin = reinterpret_cast<char *>(&nodes_[keys]);
+    size_t slots = keys + (n_children + 3) / 4;
+    uint32_t i = n_children;
+    for (auto it = cur_inner->rbegin(), it_end = cur_inner->rend();
+         it != it_end; ++it) {
+      --i;
+      keys_begin[i] = *it;
+      node_stack.push(std::make_pair(*cur_inner->find_child(*it), slots + i));
+    }
+  }
+  nodes_.shrink_to_fit();
+  prefix_pool_.shrink_to_fit();
+  values_.shrink_to_fit();
+}
+
+template <class T> uint32_t frozen_art<T>::prefix_len(uint32_t n) const {
+  return nodes_[n + 1] & 0xffff;
+}
+
+template <class T> uint32_t frozen_art<T>::n_children(uint32_t n) const {
+  return nodes_[n + 1] >> 16;
+}
+
+template <class T> const char *frozen_art<T>::prefix(uint32_t n) const {
+  return prefix_pool_.data() + nodes_[n];
+}
+
+template <class T> const char *frozen_art<T>::partial_keys(uint32_t n) const {
+  return reinterpret_cast<const char *>(&nodes_[n + 2]);
+}
+
+template <class T>
+const uint32_t *frozen_art<T>::children(uint32_t n) const {
+  return &nodes_[n + 2 + (n_children(n) + 3) / 4];
+}
+
+template <class T> uint32_t frozen_art<T>::value_index(uint32_t n) const {
+  return nodes_[n + 2];
+}
+
+template <class T>
+uint32_t frozen_art<T>::lower_child(uint32_t n, char partial_key) const {
+  uint32_t n_children = this->n_children(n);
+  const char *keys = partial_keys(n);
+  if (n_children == 256) {
+    return 128 + partial_key;
+  }
+  if (n_children <= 16) {
+    uint32_t i = 0;
+    while (i < n_children && keys[i] < partial_key) {
+      ++i;
+    }
+    return i;
+  }
+  return std::lower_bound(keys, keys + n_children, partial_key) - keys;
+}
+
+template <class T> T frozen_art<T>::get(const char *key) const {
+  if (nodes_.empty()) {
+    return T{};
+  }
+  uint32_t cur = 0, prefix_len, i;
+  int depth = 0, key_len = std::strlen(key) + 1;
+  while (true) {
+    prefix_len = this->prefix_len(cur);
+    if (static_cast<int>(prefix_len) > key_len - depth ||
+        std::memcmp(prefix(cur), key + depth, prefix_len) != 0) {
+      /* prefix mismatch */
+      return T{};
+    }
+    if (static_cast<int>(prefix_len) == key_len - depth) {
+      /* exact match */
+      return n_children(cur) == 0 ? values_[value_index(cur)] : T{};
+    }
+    char partial_key = key[depth + prefix_len];
+    i = lower_child(cur, partial_key);
+    if (i == n_children(cur) || partial_keys(cur)[i] != partial_key) {
+      return T{};
+    }
+    depth += prefix_len + 1;
+    cur = children(cur)[i];
+  }
+}
+
+template <class T> size_t frozen_art<T>::size() const {
+  return values_.size();
+}
+
+template <class T> size_t frozen_art<T>::memory_usage() const {
+  return nodes_.size() * sizeof(uint32_t) + prefix_pool_.size() +
+         values_.size() * sizeof(T);
+}
+
+template <class T>
+typename frozen_art<T>::iterator frozen_art<T>::begin() const {
+  iterator it(this);
+  if (!nodes_.empty()) {
+    it.seek_leaf(0);
+  }
+  return it;
+}
+
+template <class T>
+typename frozen_art<T>::iterator frozen_art<T>::begin(const char *key) const {
+  iterator it(this);
+  if (nodes_.empty()) {
+    return it;
+  }
+  int key_len = std::strlen(key);
+  uint32_t cur = 0;
+  while (true) {
+    int prefix_len = this->prefix_len(cur);
+    const char *prefix = this->prefix(cur);
+    int depth = it.key_.size();
+    int prefix_match_len = common_prefix_len(
+        prefix, key + depth, std::min(prefix_len, key_len - depth));
+    if (prefix_match_len == key_len - depth) {
+      /* search key is exhausted, all keys of the subtree are greater */
+      it.seek_leaf(cur);
+      return it;
+    }
+    if (prefix_match_len < prefix_len) {
+      if (key[depth + prefix_match_len] < prefix[prefix_match_len]) {
+        /* all keys of the subtree are greater */
+        it.seek_leaf(cur);
+      } else {
+        /* all keys of the subtree are lesser */
+        it.seek_next();
+      }
+      return it;
+    }
+    if (n_children(cur) == 0) {
+      it.seek_next();
+      return it;
+    }
+    char partial_key = key[depth + prefix_len];
+    uint32_t i = lower_child(cur, partial_key);
+    if (i == n_children(cur)) {
+      it.push(cur, i - 1);
+      it.seek_next();
+      return it;
+    }
+    it.push(cur, i);
+    if (partial_keys(cur)[i] != partial_key) {
+      it.seek_leaf(children(cur)[i]);
+      return it;
+    }
+    cur = children(cur)[i];
+  }
+}
+
+template <class T>
+typename frozen_art<T>::iterator frozen_art<T>::end() const {
+  return iterator(this);
+}
+
+template <class T>
+frozen_art<T>::iterator::iterator(const frozen_art<T> *tree) : tree_(tree) {}
+
+template <class T>
+void frozen_art<T>::iterator::push(uint32_t n, uint32_t child) {
+  key_.append(tree_->prefix(n), tree_->prefix_len(n));
+  stack_.push_back({n, child, key_.size()});
+  key_.push_back(tree_->partial_keys(n)[child]);
+}
+
+template <class T> void frozen_art<T>::iterator::seek_leaf(uint32_t n) {
+  /* find leftmost leaf node */
+  while (tree_->n_children(n) != 0) {
+    push(n, 0);
+    n = tree_->children(n)[0];
+  }
+  key_.append(tree_->prefix(n), tree_->prefix_len(n));
+  value_ = tree_->value_index(n);
+}
+
+template <class T> void frozen_art<T>::iterator::seek_next() {
+  /* traverse up until a node with a next child is found or stack gets empty */
+  while (!stack_.empty()) {
+    frame &top = stack_.back();
+    if (top.child_ + 1 < tree_->n_children(top.node_)) {
+      ++top.child_;
+      key_.resize(top.key_len_);
+      key_.push_back(tree_->partial_keys(top.node_)[top.child_]);
+      seek_leaf(tree_->children(top.node_)[top.child_]);
+      return;
+    }
+    stack_.pop_back();
+  }
+  key_.clear();
+  value_ = END;
+}
+
+template <class T>
+typename frozen_art<T>::iterator::reference
+frozen_art<T>::iterator::operator*() const {
+  return tree_->values_[value_];
+}
+
+template <class T>
+typename frozen_art<T>::iterator::pointer
+frozen_art<T>::iterator::operator->() const {
+  return &tree_->values_[value_];
+}
+
+template <class T>
+typename frozen_art<T>::iterator &frozen_art<T>::iterator::operator++() {
+  seek_next();
+  return *this;
+}
+
+template <class T>
+typename frozen_art<T>::iterator frozen_art<T>::iterator::operator++(int) {
+  auto old = *this;
+  operator++();
+  return old;
+}
+
+template <class T>
+bool frozen_art<T>::iterator::operator==(const iterator &rhs) const {
+  return value_ == rhs.value_;
+}
+
+template <class T>
+bool frozen_art<T>::iterator::operator!=(const iterator &rhs) const {
+  return !(*this == rhs);
+}
+
+template <class T> const std::string frozen_art<T>::iterator::key() const {
+  /* strip the terminating null byte */
+  return key_.substr(0, key_.size() - 1);
+}
+
+} // namespace art
+
+#endif
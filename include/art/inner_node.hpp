@@ -80,12 +80,6 @@ public:
    */
   virtual bool is_full() const = 0;
 
-  /**
-   * Determines if the node is underfull, i.e. carries less child nodes than
-   * intended.
-   */
-  virtual bool is_underfull() const = 0;
-
   virtual int n_children() const = 0;
 
   virtual char next_partial_key(char partial_key) const = 0;
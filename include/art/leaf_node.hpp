@@ -10,12 +10,12 @@
 
 namespace art {
 
-template <class T> class art;
-
 template <class T> class leaf_node : public node<T> {
 public:
   explicit leaf_node(T value);
   bool is_leaf() const override;
+  node_type type() const override;
+  node<T> *clone() const override;
 
   T value_;
 };
@@ -26,6 +26,46 @@ leaf_node<T>::leaf_node(T value): value_(value) {}
 template <class T> 
 bool leaf_node<T>::is_leaf() const { return true; }
 
+template <class T>
+node_type leaf_node<T>::type() const { return node_type::leaf; }
+
+template <class T>
+node<T> *leaf_node<T>::clone() const {
+  auto new_node = new leaf_node<T>(*this);
+  new_node->init_clone();
+  return new_node;
+}
+
+/**
+ * Value type of the leaves of art<void>, i.e., of a set.
+ * A template, so that the static value_ of its leaf_node can be defined in
+ * this header.
+ */
+template <class Tag = void> struct empty_value {};
+
+typedef empty_value<> no_value;
+
+/**
+ * Leaf which stores no value, only its prefix, i.e., the key's last bytes.
+ * The value_ is shared by all leaves, an empty_value carries no state.
+ */
+template <class Tag>
+class leaf_node<empty_value<Tag>> : public node<empty_value<Tag>> {
+public:
+  explicit leaf_node(empty_value<Tag>) {}
+  bool is_leaf() const override { return true; }
+  node_type type() const override { return node_type::leaf; }
+  node<empty_value<Tag>> *clone() const override {
+    auto new_node = new leaf_node<empty_value<Tag>>(*this);
+    new_node->init_clone();
+    return new_node;
+  }
+
+  static empty_value<Tag> value_;
+};
+
+template <class Tag> empty_value<Tag> leaf_node<empty_value<Tag>>::value_;
+
 } // namespace art
 
 #endif
@@ -0,0 +1,724 @@
+/**
+ * @file memory mappable read-only tree image header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_MAPPED_ART_HPP
+#define ART_MAPPED_ART_HPP
+
+#include "art.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace art {
+
+/**
+ * Read-only tree which is queried directly on an image produced by
+ * mapped_art::write, typically a memory mapped file.
+ * Children are referenced by their offset from the start of the image instead
+ * of by pointer, which makes the image position independent. Processes
+ * mapping the same file therefore share the page cache.
+ *
+ * Image layout (native byte order, every record 8 byte aligned):
+ *
+ *   header:   magic, version, sizeof(T)
+ *   node*:    node header, payload, prefix bytes
+ *   trailer:  offset of root node (0 if empty), number of keys, magic
+ *
+ * Payload by node type, a child offset of 0 denotes a missing child:
+ *
+ *   leaf:     value
+ *   node_4:   keys[4], children[4]
+ *   node_16:  keys[16], children[16], also written for node_8
+ *   node_48:  indexes[256], children[48]
+ *   node_256: children[256]
+ */
+template <class T> class mapped_art {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "mapped_art requires a trivially copyable type");
+  static_assert(alignof(T) <= 8, "mapped_art requires an alignment <= 8");
+
+public:
+  class iterator;
+
+  /**
+   * Writes an image of the given tree.
+   *
+   * @throws std::runtime_error if writing to the stream fails.
+   */
+  template <class Counters, class Shrink, class Ladder>
+  static void write(const art<T, Counters, Shrink, Ladder> &tree,
+                    std::ostream &out);
+
+  /**
+   * Maps the image file at the given path read-only.
+   *
+   * @throws std::runtime_error if the file cannot be mapped or is not a valid
+   * image.
+   */
+  explicit mapped_art(const char *path);
+
+  /**
+   * Uses an image which is already in memory, no ownership is taken.
+   * The image must be 8 byte aligned.
+   *
+   * @throws std::runtime_error if the memory is not a valid image.
+   */
+  mapped_art(const char *image, size_t image_len);
+
+  mapped_art(const mapped_art<T> &other) = delete;
+  mapped_art(mapped_art<T> &&other) noexcept;
+  mapped_art<T> &operator=(const mapped_art<T> &other) = delete;
+  mapped_art<T> &operator=(mapped_art<T> &&other) noexcept;
+  ~mapped_art();
+
+  /**
+   * Finds the value associated with the given key.
+   *
+   * @param key - The key to find.
+   * @return the value associated with the key or a default constructed value.
+   */
+  T get(const char *key) const;
+
+  /**
+   * Number of keys in the image.
+   */
+  uint64_t size() const;
+
+  /**
+   * Forward iterator that traverses the image in lexicographic order.
+   */
+  iterator begin() const;
+
+  /**
+   * Forward iterator that traverses the image in lexicographic order starting
+   * from the smallest key greater or equal than the provided key.
+   */
+  iterator begin(const char *key) const;
+
+  /**
+   * Iterator to the end of the lexicographic order.
+   */
+  iterator end() const;
+
+private:
+  static const uint32_t MAGIC = 0x4d545241; // "ARTM"
+  static const uint32_t VERSION = 1;
+
+  struct header {
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t value_size_;
+    uint32_t reserved_;
+  };
+
+  struct trailer {
+    uint64_t root_;
+    uint64_t n_keys_;
+    uint32_t magic_;
+    uint32_t reserved_;
+  };
+
+  struct node_header {
+    uint8_t type_;
+    uint8_t reserved_;
+    uint16_t prefix_len_;
+    uint32_t n_children_;
+  };
+
+  static size_t payload_len(node_type type);
+  static size_t align(size_t len);
+
+  void open(const char *image, size_t image_len);
+
+  /**
+   * Checks that the node at the given offset, including its payload and
+   * prefix, lies within the image and that an inner node has children.
+   *
+   * @throws std::runtime_error if it does not.
+   */
+  void check_node(uint64_t offset) const;
+
+  const node_header *get_node(uint64_t offset) const;
+  const char *get_payload(uint64_t offset) const;
+  const char *get_prefix(uint64_t offset) const;
+  T get_value(uint64_t offset) const;
+
+  /**
+   * Finds the child with the smallest partial key greater or equal than the
+   * given partial key.
+   *
+   * @return the child offset and its partial key, or an offset of 0.
+   */
+  std::pair<uint64_t, int> next_child(uint64_t offset, int partial_key) const;
+
+  const char *image_ = nullptr;
+  size_t image_len_ = 0;
+  bool is_mapped_ = false;
+  uint64_t root_ = 0;
+  uint64_t n_keys_ = 0;
+};
+
+template <class T> class mapped_art<T>::iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = int;
+  using pointer = const T *;
+  using reference = T;
+
+  iterator() = default;
+
+  value_type operator*() const;
+  iterator &operator++();
+  iterator operator++(int);
+  bool operator==(const iterator &rhs) const;
+  bool operator!=(const iterator &rhs) const;
+
+  /**
+   * The key of the current entry.
+   */
+  const std::string key() const;
+
+private:
+  friend class mapped_art<T>;
+
+  struct frame {
+    uint64_t node_;
+    int partial_key_;
+    size_t key_len_;
+  };
+
+  explicit iterator(const mapped_art<T> *image);
+
+  void push(uint64_t offset);
+  void seek_leaf(uint64_t offset);
+  void seek_next();
+
+  const mapped_art<T> *image_ = nullptr;
+  std::vector<frame> stack_;
+  std::string key_;
+  uint64_t leaf_ = 0;
+};
+
+template <class T> size_t mapped_art<T>::align(size_t len) {
+  return (len + 7) & ~static_cast<size_t>(7);
+}
+
+template <class T> size_t mapped_art<T>::payload_len(node_type type) {
+  switch (type) {
+  case node_type::leaf:
+    return align(sizeof(T));
+  case node_type::node_4:
+    return 8 + 4 * sizeof(uint64_t);
+  case node_type::node_16:
+    return 16 + 16 * sizeof(uint64_t);
+  case node_type::node_48:
+    return 256 + 48 * sizeof(uint64_t);
+  case node_type::node_256:
+    return 256 * sizeof(uint64_t);
+  default:
+    throw std::runtime_error("invalid node type");
+  }
+}
+
+template <class T>
+template <class Counters, class Shrink, class Ladder>
+void mapped_art<T>::write(const art<T, Counters, Shrink, Ladder> &tree,
+                          std::ostream &out) {
+  struct frame {
+    inner_node<T> *node_;
+    child_it<T> it_, it_end_;
+    char partial_key_;
+    std::vector<std::pair<char, uint64_t>> children_;
+  };
+
+  header h = {MAGIC, VERSION, sizeof(T), 0};
+  out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+  uint64_t offset = sizeof(h);
+  uint64_t n_keys = 0;
+
+  /* post-order traversal, so child offsets are known when the parent is
+   * written */
+  std::vector<frame> node_stack;
+  node<T> *cur = tree.root_;
+  std::vector<char> buf;
+  while (cur != nullptr || !node_stack.empty()) {
+    if (cur != nullptr && !cur->is_leaf()) {
+      auto cur_inner = static_cast<inner_node<T> *>(cur);
+      node_stack.push_back(
+          {cur_inner, cur_inner->begin(), cur_inner->end(), 0, {}});
+      cur = nullptr;
+      continue;
+    }
+
+    std::vector<std::pair<char, uint64_t>> children;
+    if (cur == nullptr) {
+      frame &top = node_stack.back();
+      if (top.it_ != top.it_end_) {
+        /* descend into next child */
+        top.partial_key_ = top.it_.get_partial_key();
+        cur = top.it_.get_child_node();
+        ++top.it_;
+        continue;
+      }
+      cur = top.node_;
+      children = std::move(top.children_);
+      node_stack.pop_back();
+    }
+
+    /* write node, all its children are written, a node_8 fits the node_16
+     * layout */
+    node_type type =
+        cur->type() == node_type::node_8 ? node_type::node_16 : cur->type();
+    node_header nh = {static_cast<uint8_t>(type), 0, cur->prefix_len_,
+                      static_cast<uint32_t>(children.size())};
+    size_t len = payload_len(type);
+    buf.assign(sizeof(nh) + len + align(cur->prefix_len_), 0);
+    std::memcpy(buf.data(), &nh, sizeof(nh));
+    char *payload = buf.data() + sizeof(nh);
+    uint8_t i = 0;
+    switch (cur->type()) {
+    case node_type::leaf:
+      std::memcpy(payload, &static_cast<leaf_node<T> *>(cur)->value_,
+                  sizeof(T));
+      ++n_keys;
+      break;
+    case node_type::node_4:
+    case node_type::node_8:
+    case node_type::node_16: {
+      size_t capacity = type == node_type::node_4 ? 4 : 16;
+      char *keys = payload;
+      char *offsets = payload + (capacity == 4 ? 8 : 16);
+      for (const auto &child : children) {
+        keys[i] = child.first;
+        std::memcpy(offsets + i * sizeof(uint64_t), &child.second,
+                    sizeof(uint64_t));
+        ++i;
+      }
+      break;
+    }
+    case node_type::node_48: {
+      uint8_t *indexes = reinterpret_cast<uint8_t *>(payload);
+      std::fill(indexes, indexes + 256, 48);
+      for (const auto &child : children) {
+        indexes[128 + child.first] = i;
+        std::memcpy(payload + 256 + i * sizeof(uint64_t), &child.second,
+                    sizeof(uint64_t));
+        ++i;
+      }
+      break;
+    }
+    case node_type::node_256:
+      for (const auto &child : children) {
+        std::memcpy(payload + (128 + child.first) * sizeof(uint64_t),
+                    &child.second, sizeof(uint64_t));
+      }
+      break;
+    }
+    std::copy(cur->prefix_, cur->prefix_ + cur->prefix_len_, payload + len);
+    out.write(buf.data(), buf.size());
+
+    if (node_stack.empty()) {
+      /* root */
+      cur = nullptr;
+      break;
+    }
+    node_stack.back().children_.push_back(
+        std::make_pair(node_stack.back().partial_key_, offset));
+    offset += buf.size();
+    cur = nullptr;
+  }
+
+  trailer t = {tree.root_ != nullptr ? offset : 0, n_keys, MAGIC, 0};
+  out.write(reinterpret_cast<const char *>(&t), sizeof(t));
+  if (!out) {
+    throw std::runtime_error("failed to write image");
+  }
+}
+
+template <class T> mapped_art<T>::mapped_art(const char *path) {
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error(std::string("cannot open image ") + path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error(std::string("cannot stat image ") + path);
+  }
+  size_t image_len = st.st_size;
+  void *image = image_len > 0
+                    ? mmap(nullptr, image_len, PROT_READ, MAP_SHARED, fd, 0)
+                    : MAP_FAILED;
+  ::close(fd);
+  if (image == MAP_FAILED) {
+    throw std::runtime_error(std::string("cannot map image ") + path);
+  }
+  is_mapped_ = true;
+  try {
+    open(static_cast<const char *>(image), image_len);
+  } catch (...) {
+    munmap(image, image_len);
+    throw;
+  }
+}
+
+template <class T>
+mapped_art<T>::mapped_art(const char *image, size_t image_len) {
+  open(image, image_len);
+}
+
+template <class T>
+mapped_art<T>::mapped_art(mapped_art<T> &&other) noexcept
+    : image_(other.image_), image_len_(other.image_len_),
+      is_mapped_(other.is_mapped_), root_(other.root_),
+      n_keys_(other.n_keys_) {
+  other.image_ = nullptr;
+  other.is_mapped_ = false;
+}
+
+template <class T>
+mapped_art<T> &mapped_art<T>::operator=(mapped_art<T> &&other) noexcept {
+  if (this != &other) {
+    std::swap(image_, other.image_);
+    std::swap(image_len_, other.image_len_);
+    std::swap(is_mapped_, other.is_mapped_);
+    std::swap(root_, other.root_);
+    std::swap(n_keys_, other.n_keys_);
+  }
+  return *this;
+}
+
+template <class T> mapped_art<T>::~mapped_art() {
+  if (is_mapped_ && image_ != nullptr) {
+    munmap(const_cast<char *>(image_), image_len_);
+  }
+}
+
+template <class T>
+void mapped_art<T>::open(const char *image, size_t image_len) {
+  if (image_len < sizeof(header) + sizeof(trailer) ||
+      reinterpret_cast<uintptr_t>(image) % 8 != 0) {
+    throw std::runtime_error("not an image");
+  }
+  header h;
+  trailer t;
+  std::memcpy(&h, image, sizeof(h));
+  std::memcpy(&t, image + image_len - sizeof(t), sizeof(t));
+  if (h.magic_ != MAGIC || t.magic_ != MAGIC) {
+    throw std::runtime_error("not an image or foreign byte order");
+  }
+  if (h.version_ != VERSION) {
+    throw std::runtime_error("unsupported image version");
+  }
+  if (h.value_size_ != sizeof(T)) {
+    throw std::runtime_error("image value size mismatch");
+  }
+  image_ = image;
+  image_len_ = image_len;
+  root_ = t.root_;
+  n_keys_ = t.n_keys_;
+  if (root_ != 0) {
+    check_node(root_);
+  }
+}
+
+template <class T> void mapped_art<T>::check_node(uint64_t offset) const {
+  uint64_t nodes_end = image_len_ - sizeof(trailer);
+  if (offset < sizeof(header) || offset % 8 != 0 ||
+      offset > nodes_end - sizeof(node_header)) {
+    throw std::runtime_error("corrupt image");
+  }
+  const node_header *n = get_node(offset);
+  uint32_t capacity;
+  switch (static_cast<node_type>(n->type_)) {
+  case node_type::leaf:
+    capacity = 0;
+    break;
+  case node_type::node_4:
+    capacity = 4;
+    break;
+  case node_type::node_16:
+    capacity = 16;
+    break;
+  case node_type::node_48:
+    capacity = 48;
+    break;
+  case node_type::node_256:
+    capacity = 256;
+    break;
+  default:
+    throw std::runtime_error("corrupt image");
+  }
+  if (n->n_children_ > capacity ||
+      (capacity != 0 && n->n_children_ == 0) ||
+      nodes_end - offset - sizeof(node_header) <
+          payload_len(static_cast<node_type>(n->type_)) +
+              align(n->prefix_len_)) {
+    throw std::runtime_error("corrupt image");
+  }
+}
+
+template <class T>
+const typename mapped_art<T>::node_header *
+mapped_art<T>::get_node(uint64_t offset) const {
+  return reinterpret_cast<const node_header *>(image_ + offset);
+}
+
+template <class T>
+const char *mapped_art<T>::get_payload(uint64_t offset) const {
+  return image_ + offset + sizeof(node_header);
+}
+
+template <class T>
+const char *mapped_art<T>::get_prefix(uint64_t offset) const {
+  return get_payload(offset) +
+         payload_len(static_cast<node_type>(get_node(offset)->type_));
+}
+
+template <class T> T mapped_art<T>::get_value(uint64_t offset) const {
+  T value;
+  std::memcpy(&value, get_payload(offset), sizeof(T));
+  return value;
+}
+
+template <class T>
+std::pair<uint64_t, int> mapped_art<T>::next_child(uint64_t offset,
+                                                   int partial_key) const {
+  const node_header *n = get_node(offset);
+  const char *payload = get_payload(offset);
+  uint64_t child = 0;
+  switch (static_cast<node_type>(n->type_)) {
+  case node_type::node_4:
+  case node_type::node_16: {
+    const char *offsets =
+        payload +
+        (n->type_ == static_cast<uint8_t>(node_type::node_4) ? 8 : 16);
+    uint32_t i = 0;
+    for (; i < n->n_children_ && payload[i] < partial_key; ++i) {
+    }
+    if (i < n->n_children_) {
+      partial_key = payload[i];
+      std::memcpy(&child, offsets + i * sizeof(uint64_t), sizeof(uint64_t));
+    }
+    break;
+  }
+  case node_type::node_48: {
+    const uint8_t *indexes = reinterpret_cast<const uint8_t *>(payload);
+    for (; partial_key < 128 && indexes[128 + partial_key] == 48;
+         ++partial_key) {
+    }
+    if (partial_key < 128) {
+      uint8_t index = indexes[128 + partial_key];
+      if (index > 48) {
+        throw std::runtime_error("corrupt image");
+      }
+      std::memcpy(&child, payload + 256 + index * sizeof(uint64_t),
+                  sizeof(uint64_t));
+    }
+    break;
+  }
+  case node_type::node_256:
+    for (; partial_key < 128 && child == 0; ++partial_key) {
+      std::memcpy(&child, payload + (128 + partial_key) * sizeof(uint64_t),
+                  sizeof(uint64_t));
+    }
+    --partial_key;
+    break;
+  default:
+    break;
+  }
+  if (child == 0) {
+    return std::make_pair(0, 0);
+  }
+  /* nodes are written in post-order, children precede their parent */
+  if (child >= offset) {
+    throw std::runtime_error("corrupt image");
+  }
+  check_node(child);
+  return std::make_pair(child, partial_key);
+}
+
+template <class T> T mapped_art<T>::get(const char *key) const {
+  uint64_t cur = root_;
+  int depth = 0, key_len = std::strlen(key) + 1;
+  while (cur != 0) {
+    const node_header *n = get_node(cur);
+    if (n->prefix_len_ > key_len - depth ||
+        std::memcmp(get_prefix(cur), key + depth, n->prefix_len_) != 0) {
+      /* prefix mismatch */
+      return T{};
+    }
+    if (n->prefix_len_ == key_len - depth) {
+      /* exact match */
+      return n->type_ == static_cast<uint8_t>(node_type::leaf) ? get_value(cur)
+                                                                : T{};
+    }
+    char partial_key = key[depth + n->prefix_len_];
+    std::pair<uint64_t, int> child = next_child(cur, partial_key);
+    depth += n->prefix_len_ + 1;
+    cur = child.first != 0 && child.second == partial_key ? child.first : 0;
+  }
+  return T{};
+}
+
+template <class T> uint64_t mapped_art<T>::size() const { return n_keys_; }
+
+template <class T>
+typename mapped_art<T>::iterator mapped_art<T>::begin() const {
+  return begin("");
+}
+
+template <class T>
+typename mapped_art<T>::iterator mapped_art<T>::begin(const char *key) const {
+  iterator it(this);
+  if (root_ == 0) {
+    return it;
+  }
+  int key_len = std::strlen(key);
+  uint64_t cur = root_;
+  while (true) {
+    const node_header *n = get_node(cur);
+    const char *prefix = get_prefix(cur);
+    int depth = it.key_.size();
+    int prefix_match_len = common_prefix_len(
+        prefix, key + depth, std::min<int>(n->prefix_len_, key_len - depth));
+    if (prefix_match_len == key_len - depth) {
+      /* search key is exhausted, all keys of the subtree are greater */
+      it.seek_leaf(cur);
+      return it;
+    }
+    if (prefix_match_len < n->prefix_len_) {
+      if (key[depth + prefix_match_len] < prefix[prefix_match_len]) {
+        /* all keys of the subtree are greater */
+        it.seek_leaf(cur);
+      } else {
+        /* all keys of the subtree are lesser */
+        it.seek_next();
+      }
+      return it;
+    }
+    if (n->type_ == static_cast<uint8_t>(node_type::leaf)) {
+      it.seek_next();
+      return it;
+    }
+    it.push(cur);
+    char partial_key = key[depth + n->prefix_len_];
+    std::pair<uint64_t, int> child = next_child(cur, partial_key);
+    if (child.first == 0) {
+      it.stack_.back().partial_key_ = 127;
+      it.seek_next();
+      return it;
+    }
+    it.stack_.back().partial_key_ = child.second;
+    it.key_.push_back(static_cast<char>(child.second));
+    if (child.second != partial_key) {
+      it.seek_leaf(child.first);
+      return it;
+    }
+    cur = child.first;
+  }
+}
+
+template <class T>
+typename mapped_art<T>::iterator mapped_art<T>::end() const {
+  return iterator(this);
+}
+
+template <class T>
+mapped_art<T>::iterator::iterator(const mapped_art<T> *image)
+    : image_(image) {}
+
+template <class T> void mapped_art<T>::iterator::push(uint64_t offset) {
+  const node_header *n = image_->get_node(offset);
+  key_.append(image_->get_prefix(offset), n->prefix_len_);
+  stack_.push_back({offset, -129, key_.size()});
+}
+
+template <class T> void mapped_art<T>::iterator::seek_leaf(uint64_t offset) {
+  /* find leftmost leaf node */
+  while (image_->get_node(offset)->type_ !=
+         static_cast<uint8_t>(node_type::leaf)) {
+    push(offset);
+    std::pair<uint64_t, int> child = image_->next_child(offset, -128);
+    if (child.first == 0) {
+      /* inner nodes have at least one child */
+      throw std::runtime_error("corrupt image");
+    }
+    stack_.back().partial_key_ = child.second;
+    key_.push_back(static_cast<char>(child.second));
+    offset = child.first;
+  }
+  key_.append(image_->get_prefix(offset), image_->get_node(offset)->prefix_len_);
+  leaf_ = offset;
+}
+
+template <class T> void mapped_art<T>::iterator::seek_next() {
+  /* traverse up until a node with a next child is found or stack gets empty */
+  while (!stack_.empty()) {
+    frame &top = stack_.back();
+    std::pair<uint64_t, int> child =
+        top.partial_key_ < 127 ? image_->next_child(top.node_, top.partial_key_ + 1)
+                               : std::pair<uint64_t, int>(0, 0);
+    if (child.first != 0) {
+      top.partial_key_ = child.second;
+      key_.resize(top.key_len_);
+      key_.push_back(static_cast<char>(child.second));
+      seek_leaf(child.first);
+      return;
+    }
+    stack_.pop_back();
+  }
+  key_.clear();
+  leaf_ = 0;
+}
+
+template <class T>
+typename mapped_art<T>::iterator::value_type
+mapped_art<T>::iterator::operator*() const {
+  return image_->get_value(leaf_);
+}
+
+template <class T>
+typename mapped_art<T>::iterator &mapped_art<T>::iterator::operator++() {
+  seek_next();
+  return *this;
+}
+
+template <class T>
+typename mapped_art<T>::iterator mapped_art<T>::iterator::operator++(int) {
+  auto old = *this;
+  operator++();
+  return old;
+}
+
+template <class T>
+bool mapped_art<T>::iterator::operator==(const iterator &rhs) const {
+  return leaf_ == rhs.leaf_;
+}
+
+template <class T>
+bool mapped_art<T>::iterator::operator!=(const iterator &rhs) const {
+  return !(*this == rhs);
+}
+
+template <class T>
+const std::string mapped_art<T>::iterator::key() const {
+  /* strip the terminating null byte */
+  return key_.substr(0, key_.size() - 1);
+}
+
+} // namespace art
+
+#endif
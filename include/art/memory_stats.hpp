@@ -0,0 +1,57 @@
+/**
+ * @file memory accounting header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_MEMORY_STATS_HPP
+#define ART_MEMORY_STATS_HPP
+
+#include "node.hpp"
+#include <cstdint>
+
+namespace art {
+
+/**
+ * Memory usage of a tree, see art::memory_stats.
+ * Counts are maintained incrementally by the tree, byte figures are derived
+ * from the counts and the node sizes.
+ */
+struct memory_stats {
+  struct node_stats {
+    uint64_t count_ = 0;    // number of nodes
+    uint64_t children_ = 0; // number of used child slots
+    uint64_t bytes_ = 0;    // bytes of the node objects, excluding prefixes
+  };
+
+  /* indexed by node_type */
+  node_stats nodes_[n_node_types];
+
+  /* bytes of all prefixes */
+  uint64_t prefix_bytes_ = 0;
+
+  /* bytes of unused child slots in node_48 and node_256 */
+  uint64_t slack_bytes_ = 0;
+
+  /* bytes of all nodes and prefixes */
+  uint64_t total_bytes_ = 0;
+
+  /* total bytes divided by the number of keys, 0 if the tree is empty */
+  double bytes_per_key_ = 0;
+
+  node_stats &operator[](node_type type) {
+    return nodes_[static_cast<int>(type)];
+  }
+
+  const node_stats &operator[](node_type type) const {
+    return nodes_[static_cast<int>(type)];
+  }
+
+  /**
+   * Number of keys, i.e., leaf nodes.
+   */
+  uint64_t n_keys() const { return (*this)[node_type::leaf].count_; }
+};
+
+} // namespace art
+
+#endif
@@ -6,6 +6,7 @@
 #ifndef ART_NODE_HPP
 #define ART_NODE_HPP
 
+#include "simd.hpp"
 #include <algorithm>
 #include <array>
 #include <cassert>
@@ -17,6 +18,22 @@
 
 namespace art {
 
+/**
+ * Identifies the concrete type of a node.
+ * The numeric values are part of the serialization format.
+ */
+enum class node_type : uint8_t {
+  leaf = 0,
+  node_4 = 1,
+  node_16 = 2,
+  node_48 = 3,
+  node_256 = 4,
+  node_8 = 5,
+};
+
+/* number of node types, i.e., one more than the largest node_type */
+const int n_node_types = 6;
+
 template <class T> class node {
 public:
   virtual ~node() = default;
@@ -33,6 +50,11 @@ public:
    */
   virtual bool is_leaf() const = 0;
 
+  /**
+   * Determines the concrete type of this node.
+   */
+  virtual node_type type() const = 0;
+
   /**
    * Determines the number of matching bytes between the node's prefix and the key.
    *
@@ -44,16 +66,78 @@ public:
    * prefix:  "abbbd"
    *           ^^^^*
    * index:    01234
+   *
+   * At most key_len bytes of the key are read, i.e., the result never
+   * exceeds key_len.
    */
   int check_prefix(const char *key, int key_len) const;
 
+  /**
+   * Creates a copy of this node which shares all children with this node.
+   * The prefix is copied and every child gains a reference.
+   * Used for path copying when the node is shared with a snapshot.
+   *
+   * @return the copy, owned by the caller.
+   */
+  virtual node<T> *clone() const = 0;
+
+  /**
+   * Determines if the node is referenced by more than one parent or tree,
+   * i.e., must be copied before it is modified.
+   */
+  bool is_shared() const;
+
+  /**
+   * Adds a reference to this node.
+   */
+  void retain();
+
+  /**
+   * Drops a reference to this node.
+   * The node itself is not deleted, the caller is responsible for that.
+   *
+   * @return true if the last reference was dropped.
+   */
+  bool release();
+
   char *prefix_ = nullptr;
   uint16_t prefix_len_ = 0;
+
+  /* number of parents and trees referencing this node, atomic access only */
+  uint32_t ref_count_ = 1;
+
+protected:
+  /**
+   * Prepares a node which was copy constructed from another node to be used
+   * as a clone, i.e., gives it a fresh reference count and its own prefix.
+   */
+  void init_clone();
 };
 
 template <class T>
-int node<T>::check_prefix(const char *key, int /* key_len */) const {
-  return std::mismatch(prefix_, prefix_ + prefix_len_, key).second - key;
+int node<T>::check_prefix(const char *key, int key_len) const {
+  return common_prefix_len(prefix_, key, std::min<int>(prefix_len_, key_len));
+}
+
+template <class T> bool node<T>::is_shared() const {
+  return __atomic_load_n(&ref_count_, __ATOMIC_ACQUIRE) > 1;
+}
+
+template <class T> void node<T>::retain() {
+  __atomic_add_fetch(&ref_count_, 1, __ATOMIC_RELAXED);
+}
+
+template <class T> bool node<T>::release() {
+  return __atomic_sub_fetch(&ref_count_, 1, __ATOMIC_ACQ_REL) == 0;
+}
+
+template <class T> void node<T>::init_clone() {
+  ref_count_ = 1;
+  if (prefix_ != nullptr) {
+    auto old_prefix = prefix_;
+    prefix_ = new char[prefix_len_];
+    std::copy(old_prefix, old_prefix + prefix_len_, prefix_);
+  }
 }
 
 } // namespace art
@@ -7,6 +7,7 @@
 #define ART_NODE_16_HPP
 
 #include "inner_node.hpp"
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <stdexcept>
@@ -25,13 +26,17 @@ template <class T> class node_16 : public inner_node<T> {
 friend class node_4<T>;
 friend class node_48<T>;
 public:
+  static const node_type TYPE = node_type::node_16;
+  static const int CAPACITY = 16;
+
   node<T> **find_child(char partial_key) override;
   void set_child(char partial_key, node<T> *child) override;
   node<T> *del_child(char partial_key) override;
   inner_node<T> *grow() override;
   inner_node<T> *shrink() override;
+  node<T> *clone() const override;
+  node_type type() const override;
   bool is_full() const override;
-  bool is_underfull() const override;
 
   char next_partial_key(char partial_key) const override;
 
@@ -40,6 +45,13 @@ public:
   int n_children() const override;
 
 private:
+  /**
+   * Bitmask of the children whose partial key is lesser/greater than the
+   * given partial key, bit i corresponds to keys_[i].
+   */
+  int less_mask(char partial_key) const;
+  int greater_mask(char partial_key) const;
+
   uint8_t n_children_ = 0;
   char keys_[16];
   node<T> *children_[16];
@@ -72,39 +84,31 @@ template <class T> node<T> **node_16<T>::find_child(char partial_key) {
 
 template <class T>
 void node_16<T>::set_child(char partial_key, node<T> *child) {
-  /* determine index for child */
-  int child_i = 0;
-  for (int i = this->n_children_ - 1;; --i) {
-    if (i >= 0 && partial_key < this->keys_[i]) {
-      /* move existing sibling to the right */
-      this->keys_[i + 1] = this->keys_[i];
-      this->children_[i + 1] = this->children_[i];
-    } else {
-      child_i = i + 1;
-      break;
-    }
-  }
-
-  this->keys_[child_i] = partial_key;
-  this->children_[child_i] = child;
+  /* keys are sorted, the number of lesser keys is the index for child */
+  int child_i = __builtin_popcount(less_mask(partial_key));
+  std::copy_backward(keys_ + child_i, keys_ + n_children_,
+                     keys_ + n_children_ + 1);
+  std::copy_backward(children_ + child_i, children_ + n_children_,
+                     children_ + n_children_ + 1);
+  keys_[child_i] = partial_key;
+  children_[child_i] = child;
   ++n_children_;
 }
 
 template <class T> node<T> *node_16<T>::del_child(char partial_key) {
-  node<T> *child_to_delete = nullptr;
-  for (int i = 0; i < n_children_; ++i) {
-    if (child_to_delete == nullptr && partial_key == keys_[i]) {
-      child_to_delete = children_[i];
-    }
-    if (child_to_delete != nullptr) {
-      /* move existing sibling to the left */
-      keys_[i] = i < n_children_ - 1 ? keys_[i + 1] : 0;
-      children_[i] = i < n_children_ - 1 ? children_[i + 1] : nullptr;
-    }
-  }
-  if (child_to_delete != nullptr) {
-    --n_children_;
+  node<T> **child = find_child(partial_key);
+  if (child == nullptr) {
+    return nullptr;
   }
+  node<T> *child_to_delete = *child;
+  int child_i = child - children_;
+  /* move the siblings to the right of the child to the left */
+  std::copy(keys_ + child_i + 1, keys_ + n_children_, keys_ + child_i);
+  std::copy(children_ + child_i + 1, children_ + n_children_,
+            children_ + child_i);
+  --n_children_;
+  keys_[n_children_] = 0;
+  children_[n_children_] = nullptr;
   return child_to_delete;
 }
 
@@ -112,10 +116,8 @@ template <class T> inner_node<T> *node_16<T>::grow() {
   auto new_node = new node_48<T>();
   new_node->prefix_ = this->prefix_;
   new_node->prefix_len_ = this->prefix_len_;
-  new_node->n_children_ = this->n_children_;
-  std::copy(this->children_, this->children_ + this->n_children_, new_node->children_);
   for (int i = 0; i < n_children_; ++i) {
-    new_node->indexes_[128 + (uint8_t) this->keys_[i]] = i;
+    new_node->set_child(keys_[i], children_[i]);
   }
   delete this;
   return new_node;
@@ -132,34 +134,70 @@ template <class T> inner_node<T> *node_16<T>::shrink() {
   return new_node;
 }
 
-template <class T> bool node_16<T>::is_full() const {
-  return n_children_ == 16;
+template <class T> node<T> *node_16<T>::clone() const {
+  auto new_node = new node_16<T>(*this);
+  new_node->init_clone();
+  for (int i = 0; i < n_children_; ++i) {
+    children_[i]->retain();
+  }
+  return new_node;
+}
+
+template <class T> node_type node_16<T>::type() const {
+  return node_type::node_16;
 }
 
-template <class T> bool node_16<T>::is_underfull() const {
-  return n_children_ == 4;
+template <class T> bool node_16<T>::is_full() const {
+  return n_children_ == 16;
 }
 
 template <class T> char node_16<T>::next_partial_key(char partial_key) const {
-  for (int i = 0; i < n_children_; ++i) {
-    if (keys_[i] >= partial_key) {
-      return keys_[i];
-    }
+  int greater_equal = ~less_mask(partial_key) & ((1 << n_children_) - 1);
+  if (greater_equal == 0) {
+    throw std::out_of_range("provided partial key does not have a successor");
   }
-  throw std::out_of_range("provided partial key does not have a successor");
+  return keys_[__builtin_ctz(greater_equal)];
 }
 
 template <class T> char node_16<T>::prev_partial_key(char partial_key) const {
-  for (int i = n_children_ - 1; i >= 0; --i) {
-    if (keys_[i] <= partial_key) {
-      return keys_[i];
-    }
+  int less_equal = ~greater_mask(partial_key) & ((1 << n_children_) - 1);
+  if (less_equal == 0) {
+    throw std::out_of_range("provided partial key does not have a predecessor");
   }
-  throw std::out_of_range("provided partial key does not have a predecessor");
+  return keys_[31 - __builtin_clz(less_equal)];
 }
 
 template <class T> int node_16<T>::n_children() const { return n_children_; }
 
+template <class T> int node_16<T>::less_mask(char partial_key) const {
+#if defined(__i386__) || defined(__amd64__)
+  /* signed comparison, same order as the partial keys */
+  return _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128((__m128i *)keys_),
+                                          _mm_set1_epi8(partial_key))) &
+         ((1 << n_children_) - 1);
+#else
+  int mask = 0;
+  for (int i = 0; i < n_children_; ++i) {
+    mask |= (keys_[i] < partial_key) << i;
+  }
+  return mask;
+#endif
+}
+
+template <class T> int node_16<T>::greater_mask(char partial_key) const {
+#if defined(__i386__) || defined(__amd64__)
+  return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadu_si128((__m128i *)keys_),
+                                          _mm_set1_epi8(partial_key))) &
+         ((1 << n_children_) - 1);
+#else
+  int mask = 0;
+  for (int i = 0; i < n_children_; ++i) {
+    mask |= (keys_[i] > partial_key) << i;
+  }
+  return mask;
+#endif
+}
+
 } // namespace art
 
 #endif
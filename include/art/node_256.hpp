@@ -7,7 +7,9 @@
 #define ART_NODE_256_HPP
 
 #include "inner_node.hpp"
+#include "simd.hpp"
 #include <array>
+#include <cstdint>
 #include <stdexcept>
 
 namespace art {
@@ -17,6 +19,9 @@ template <class T> class node_48;
 template <class T> class node_256 : public inner_node<T> {
 friend class node_48<T>;
 public:
+  static const node_type TYPE = node_type::node_256;
+  static const int CAPACITY = 256;
+
   node_256();
 
   node<T> **find_child(char partial_key) override;
@@ -24,8 +29,9 @@ public:
   node<T> *del_child(char partial_key) override;
   inner_node<T> *grow() override;
   inner_node<T> *shrink() override;
+  node<T> *clone() const override;
+  node_type type() const override;
   bool is_full() const override;
-  bool is_underfull() const override;
 
   char next_partial_key(char partial_key) const override;
 
@@ -34,8 +40,16 @@ public:
   int n_children() const override;
 
 private:
+  /**
+   * Calls f(partial_key, child) for every child in ascending partial key
+   * order.
+   */
+  template <class F> void for_each_child(F f) const;
+
   uint16_t n_children_ = 0;
   std::array<node<T> *, 256> children_;
+  /* bit 128 + partial_key is set iff partial_key has a child */
+  uint64_t present_[4] = {0, 0, 0, 0};
 };
 
 template <class T> node_256<T>::node_256() { children_.fill(nullptr); }
@@ -48,6 +62,7 @@ template <class T> node<T> **node_256<T>::find_child(char partial_key) {
 template <class T>
 void node_256<T>::set_child(char partial_key, node<T> *child) {
   children_[128 + partial_key] = child;
+  present_[(128 + partial_key) >> 6] |= 1ull << ((128 + partial_key) & 63);
   ++n_children_;
 }
 
@@ -55,6 +70,7 @@ template <class T> node<T> *node_256<T>::del_child(char partial_key) {
   node<T> *child_to_delete = children_[128 + partial_key];
   if (child_to_delete != nullptr) {
     children_[128 + partial_key] = nullptr;
+    present_[(128 + partial_key) >> 6] &= ~(1ull << ((128 + partial_key) & 63));
     --n_children_;
   }
   return child_to_delete;
@@ -68,50 +84,58 @@ template <class T> inner_node<T> *node_256<T>::shrink() {
   auto new_node = new node_48<T>();
   new_node->prefix_ = this->prefix_;
   new_node->prefix_len_ = this->prefix_len_;
-  for (int partial_key = 0; partial_key < 256; ++partial_key) {
-    if (children_[128 + partial_key] != nullptr) {
-      new_node->set_child(partial_key, children_[128 + partial_key]);
-    }
-  }
+  for_each_child([new_node](char partial_key, node<T> *child) {
+    new_node->set_child(partial_key, child);
+  });
   delete this;
   return new_node;
 }
 
-template <class T> bool node_256<T>::is_full() const {
-  return n_children_ == 256;
+template <class T> node<T> *node_256<T>::clone() const {
+  auto new_node = new node_256<T>(*this);
+  new_node->init_clone();
+  for_each_child([](char, node<T> *child) { child->retain(); });
+  return new_node;
 }
 
-template <class T> bool node_256<T>::is_underfull() const {
-  return n_children_ == 48;
+template <class T> node_type node_256<T>::type() const {
+  return node_type::node_256;
+}
+
+template <class T> bool node_256<T>::is_full() const {
+  return n_children_ == 256;
 }
 
 template <class T> char node_256<T>::next_partial_key(char partial_key) const {
-  while (true) {
-    if (children_[128 + partial_key] != nullptr) {
-      return partial_key;
-    }
-    if (partial_key == 127) {
-      throw std::out_of_range("provided partial key does not have a successor");
-    }
-    ++partial_key;
+  int i = bitmap_next(present_, 128 + partial_key);
+  if (i == -1) {
+    throw std::out_of_range("provided partial key does not have a successor");
   }
+  return i - 128;
 }
 
 template <class T> char node_256<T>::prev_partial_key(char partial_key) const {
-  while (true) {
-    if (children_[128 + partial_key] != nullptr) {
-      return partial_key;
-    }
-    if (partial_key == -128) {
-      throw std::out_of_range(
-          "provided partial key does not have a predecessor");
-    }
-    --partial_key;
+  int i = bitmap_prev(present_, 128 + partial_key);
+  if (i == -1) {
+    throw std::out_of_range(
+        "provided partial key does not have a predecessor");
   }
+  return i - 128;
 }
 
 template <class T> int node_256<T>::n_children() const { return n_children_; }
 
+template <class T>
+template <class F>
+void node_256<T>::for_each_child(F f) const {
+  for (int word = 0; word < 4; ++word) {
+    for (uint64_t bits = present_[word]; bits != 0; bits &= bits - 1) {
+      int i = 64 * word + __builtin_ctzll(bits);
+      f(static_cast<char>(i - 128), children_[i]);
+    }
+  }
+}
+
 } // namespace art
 
 #endif
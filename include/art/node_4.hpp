@@ -23,13 +23,17 @@ template <class T> class node_4 : public inner_node<T> {
   friend class node_16<T>;
 
 public:
+  static const node_type TYPE = node_type::node_4;
+  static const int CAPACITY = 4;
+
   node<T> **find_child(char partial_key) override;
   void set_child(char partial_key, node<T> *child) override;
   node<T> *del_child(char partial_key) override;
   inner_node<T> *grow() override;
   inner_node<T> *shrink() override;
+  node<T> *clone() const override;
+  node_type type() const override;
   bool is_full() const override;
-  bool is_underfull() const override;
 
   char next_partial_key(char partial_key) const override;
 
@@ -99,12 +103,21 @@ template <class T> inner_node<T> *node_4<T>::shrink() {
   throw std::runtime_error("node_4 cannot shrink");
 }
 
-template <class T> bool node_4<T>::is_full() const { return n_children_ == 4; }
+template <class T> node<T> *node_4<T>::clone() const {
+  auto new_node = new node_4<T>(*this);
+  new_node->init_clone();
+  for (int i = 0; i < n_children_; ++i) {
+    children_[i]->retain();
+  }
+  return new_node;
+}
 
-template <class T> bool node_4<T>::is_underfull() const {
-  return false;
+template <class T> node_type node_4<T>::type() const {
+  return node_type::node_4;
 }
 
+template <class T> bool node_4<T>::is_full() const { return n_children_ == 4; }
+
 template <class T> char node_4<T>::next_partial_key(char partial_key) const {
   for (int i = 0; i < n_children_; ++i) {
     if (keys_[i] >= partial_key) {
@@ -7,6 +7,7 @@
 #define ART_NODE_48_HPP
 
 #include "inner_node.hpp"
+#include "simd.hpp"
 #include <algorithm>
 #include <array>
 #include <stdexcept>
@@ -22,6 +23,9 @@ template <class T> class node_48 : public inner_node<T> {
   friend class node_256<T>;
 
 public:
+  static const node_type TYPE = node_type::node_48;
+  static const int CAPACITY = 48;
+
   node_48();
 
   node<T> **find_child(char partial_key) override;
@@ -29,8 +33,9 @@ public:
   node<T> *del_child(char partial_key) override;
   inner_node<T> *grow() override;
   inner_node<T> *shrink() override;
+  node<T> *clone() const override;
+  node_type type() const override;
   bool is_full() const override;
-  bool is_underfull() const override;
 
   char next_partial_key(char partial_key) const override;
   char prev_partial_key(char partial_key) const override;
@@ -40,9 +45,19 @@ public:
 private:
   static const char EMPTY;
 
+  /**
+   * Calls f(partial_key, child) for every child in ascending partial key
+   * order.
+   */
+  template <class F> void for_each_child(F f) const;
+
   uint8_t n_children_ = 0;
   char indexes_[256];
   node<T> *children_[48];
+  /* bit i is set iff children_[i] is free */
+  uint64_t free_slots_ = (1ull << 48) - 1;
+  /* bit 128 + partial_key is set iff partial_key has a child */
+  uint64_t present_[4] = {0, 0, 0, 0};
 };
 
 template <class T> node_48<T>::node_48() {
@@ -58,19 +73,12 @@ template <class T> node<T> **node_48<T>::find_child(char partial_key) {
 
 template <class T>
 void node_48<T>::set_child(char partial_key, node<T> *child) {
-
-  // TODO(rafaelkallis): pick random starting entry in order to increase
-  // performance? i.e. for (int i = random([0,48)); i != (i-1) % 48; i = (i+1) %
-  // 48){}
-
-  /* find empty child entry */
-  for (int i = 0; i < 48; ++i) {
-    if (children_[i] == nullptr) {
-      indexes_[128 + partial_key] = (uint8_t) i;
-      children_[i] = child;
-      break;
-    }
-  }
+  /* lowest free child entry */
+  int i = __builtin_ctzll(free_slots_);
+  free_slots_ &= free_slots_ - 1;
+  indexes_[128 + partial_key] = (uint8_t) i;
+  children_[i] = child;
+  present_[(128 + partial_key) >> 6] |= 1ull << ((128 + partial_key) & 63);
   ++n_children_;
 }
 
@@ -81,6 +89,8 @@ template <class T> node<T> *node_48<T>::del_child(char partial_key) {
     child_to_delete = children_[index];
     indexes_[128 + partial_key] = node_48::EMPTY;
     children_[index] = nullptr;
+    free_slots_ |= 1ull << index;
+    present_[(128 + partial_key) >> 6] &= ~(1ull << ((128 + partial_key) & 63));
     --n_children_;
   }
   return child_to_delete;
@@ -90,13 +100,9 @@ template <class T> inner_node<T> *node_48<T>::grow() {
   auto new_node = new node_256<T>();
   new_node->prefix_ = this->prefix_;
   new_node->prefix_len_ = this->prefix_len_;
-  uint8_t index;
-  for (int partial_key = -128; partial_key < 127; ++partial_key) {
-    index = indexes_[128 + partial_key];
-    if (index != node_48::EMPTY) {
-      new_node->set_child(partial_key, children_[index]);
-    }
-  }
+  for_each_child([new_node](char partial_key, node<T> *child) {
+    new_node->set_child(partial_key, child);
+  });
   delete this;
   return new_node;
 }
@@ -105,54 +111,64 @@ template <class T> inner_node<T> *node_48<T>::shrink() {
   auto new_node = new node_16<T>();
   new_node->prefix_ = this->prefix_;
   new_node->prefix_len_ = this->prefix_len_;
-  uint8_t index;
-  for (int partial_key = -128; partial_key < 127; ++partial_key) {
-    index = indexes_[128 + partial_key];
-    if (index != node_48::EMPTY) {
-      new_node->set_child(partial_key, children_[index]);
+  for_each_child([new_node](char partial_key, node<T> *child) {
+    new_node->set_child(partial_key, child);
+  });
+  delete this;
+  return new_node;
+}
+
+template <class T> node<T> *node_48<T>::clone() const {
+  auto new_node = new node_48<T>(*this);
+  new_node->init_clone();
+  for (int i = 0; i < 48; ++i) {
+    if (children_[i] != nullptr) {
+      children_[i]->retain();
     }
   }
-  delete this;
   return new_node;
 }
 
-template <class T> bool node_48<T>::is_full() const {
-  return n_children_ == 48;
+template <class T> node_type node_48<T>::type() const {
+  return node_type::node_48;
 }
 
-template <class T> bool node_48<T>::is_underfull() const {
-  return n_children_ == 16;
+template <class T> bool node_48<T>::is_full() const {
+  return n_children_ == 48;
 }
 
 template <class T> const char node_48<T>::EMPTY = 48;
 
 template <class T> char node_48<T>::next_partial_key(char partial_key) const {
-  while (true) {
-    if (indexes_[128 + partial_key] != node_48<T>::EMPTY) {
-      return partial_key;
-    }
-    if (partial_key == 127) {
-      throw std::out_of_range("provided partial key does not have a successor");
-    }
-    ++partial_key;
+  int i = bitmap_next(present_, 128 + partial_key);
+  if (i == -1) {
+    throw std::out_of_range("provided partial key does not have a successor");
   }
+  return i - 128;
 }
 
 template <class T> char node_48<T>::prev_partial_key(char partial_key) const {
-  while (true) {
-    if (indexes_[128 + partial_key] != node_48<T>::EMPTY) {
-      return partial_key;
-    }
-    if (partial_key == -128) {
-      throw std::out_of_range(
-          "provided partial key does not have a predecessor");
-    }
-    --partial_key;
+  int i = bitmap_prev(present_, 128 + partial_key);
+  if (i == -1) {
+    throw std::out_of_range(
+        "provided partial key does not have a predecessor");
   }
+  return i - 128;
 }
 
 template <class T> int node_48<T>::n_children() const { return n_children_; }
 
+template <class T>
+template <class F>
+void node_48<T>::for_each_child(F f) const {
+  for (int word = 0; word < 4; ++word) {
+    for (uint64_t bits = present_[word]; bits != 0; bits &= bits - 1) {
+      int i = 64 * word + __builtin_ctzll(bits);
+      f(static_cast<char>(i - 128), children_[(uint8_t)indexes_[i]]);
+    }
+  }
+}
+
 } // namespace art
 
 #endif
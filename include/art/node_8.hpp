@@ -0,0 +1,196 @@
+/**
+ * @file node_8 header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_NODE_8_HPP
+#define ART_NODE_8_HPP
+
+#include "inner_node.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__i386__) || defined(__amd64__)
+#include <emmintrin.h>
+#endif
+
+namespace art {
+
+template <class T> class node_4;
+template <class T> class node_16;
+
+/**
+ * Inner node for a fanout of 5 to 8, e.g., between node_4 and node_16 in a
+ * node_ladder. Keys are sorted and searched 8 at a time with SSE2.
+ */
+template <class T> class node_8 : public inner_node<T> {
+public:
+  static const node_type TYPE = node_type::node_8;
+  static const int CAPACITY = 8;
+
+  node<T> **find_child(char partial_key) override;
+  void set_child(char partial_key, node<T> *child) override;
+  node<T> *del_child(char partial_key) override;
+  inner_node<T> *grow() override;
+  inner_node<T> *shrink() override;
+  node<T> *clone() const override;
+  node_type type() const override;
+  bool is_full() const override;
+
+  char next_partial_key(char partial_key) const override;
+
+  char prev_partial_key(char partial_key) const override;
+
+  int n_children() const override;
+
+private:
+  /**
+   * Bitmask of the children whose partial key is equal/lesser/greater than
+   * the given partial key, bit i corresponds to keys_[i].
+   */
+  int equal_mask(char partial_key) const;
+  int less_mask(char partial_key) const;
+  int greater_mask(char partial_key) const;
+
+  uint8_t n_children_ = 0;
+  char keys_[8];
+  node<T> *children_[8];
+};
+
+template <class T> node<T> **node_8<T>::find_child(char partial_key) {
+  int bitfield = equal_mask(partial_key);
+  return bitfield != 0 ? &children_[__builtin_ctz(bitfield)] : nullptr;
+}
+
+template <class T>
+void node_8<T>::set_child(char partial_key, node<T> *child) {
+  /* keys are sorted, the number of lesser keys is the index for child */
+  int child_i = __builtin_popcount(less_mask(partial_key));
+  std::copy_backward(keys_ + child_i, keys_ + n_children_,
+                     keys_ + n_children_ + 1);
+  std::copy_backward(children_ + child_i, children_ + n_children_,
+                     children_ + n_children_ + 1);
+  keys_[child_i] = partial_key;
+  children_[child_i] = child;
+  ++n_children_;
+}
+
+template <class T> node<T> *node_8<T>::del_child(char partial_key) {
+  node<T> **child = find_child(partial_key);
+  if (child == nullptr) {
+    return nullptr;
+  }
+  node<T> *child_to_delete = *child;
+  int child_i = child - children_;
+  /* move the siblings to the right of the child to the left */
+  std::copy(keys_ + child_i + 1, keys_ + n_children_, keys_ + child_i);
+  std::copy(children_ + child_i + 1, children_ + n_children_,
+            children_ + child_i);
+  --n_children_;
+  keys_[n_children_] = 0;
+  children_[n_children_] = nullptr;
+  return child_to_delete;
+}
+
+template <class T> inner_node<T> *node_8<T>::grow() {
+  auto new_node = new node_16<T>();
+  new_node->prefix_ = this->prefix_;
+  new_node->prefix_len_ = this->prefix_len_;
+  for (int i = 0; i < n_children_; ++i) {
+    new_node->set_child(keys_[i], children_[i]);
+  }
+  delete this;
+  return new_node;
+}
+
+template <class T> inner_node<T> *node_8<T>::shrink() {
+  auto new_node = new node_4<T>();
+  new_node->prefix_ = this->prefix_;
+  new_node->prefix_len_ = this->prefix_len_;
+  for (int i = 0; i < n_children_; ++i) {
+    new_node->set_child(keys_[i], children_[i]);
+  }
+  delete this;
+  return new_node;
+}
+
+template <class T> node<T> *node_8<T>::clone() const {
+  auto new_node = new node_8<T>(*this);
+  new_node->init_clone();
+  for (int i = 0; i < n_children_; ++i) {
+    children_[i]->retain();
+  }
+  return new_node;
+}
+
+template <class T> node_type node_8<T>::type() const {
+  return node_type::node_8;
+}
+
+template <class T> bool node_8<T>::is_full() const { return n_children_ == 8; }
+
+template <class T> char node_8<T>::next_partial_key(char partial_key) const {
+  int greater_equal = ~less_mask(partial_key) & ((1 << n_children_) - 1);
+  if (greater_equal == 0) {
+    throw std::out_of_range("provided partial key does not have a successor");
+  }
+  return keys_[__builtin_ctz(greater_equal)];
+}
+
+template <class T> char node_8<T>::prev_partial_key(char partial_key) const {
+  int less_equal = ~greater_mask(partial_key) & ((1 << n_children_) - 1);
+  if (less_equal == 0) {
+    throw std::out_of_range("provided partial key does not have a predecessor");
+  }
+  return keys_[31 - __builtin_clz(less_equal)];
+}
+
+template <class T> int node_8<T>::n_children() const { return n_children_; }
+
+template <class T> int node_8<T>::equal_mask(char partial_key) const {
+#if defined(__i386__) || defined(__amd64__)
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadl_epi64((__m128i *)keys_),
+                                          _mm_set1_epi8(partial_key))) &
+         ((1 << n_children_) - 1);
+#else
+  int mask = 0;
+  for (int i = 0; i < n_children_; ++i) {
+    mask |= (keys_[i] == partial_key) << i;
+  }
+  return mask;
+#endif
+}
+
+template <class T> int node_8<T>::less_mask(char partial_key) const {
+#if defined(__i386__) || defined(__amd64__)
+  /* signed comparison, same order as the partial keys */
+  return _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadl_epi64((__m128i *)keys_),
+                                          _mm_set1_epi8(partial_key))) &
+         ((1 << n_children_) - 1);
+#else
+  int mask = 0;
+  for (int i = 0; i < n_children_; ++i) {
+    mask |= (keys_[i] < partial_key) << i;
+  }
+  return mask;
+#endif
+}
+
+template <class T> int node_8<T>::greater_mask(char partial_key) const {
+#if defined(__i386__) || defined(__amd64__)
+  return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_loadl_epi64((__m128i *)keys_),
+                                          _mm_set1_epi8(partial_key))) &
+         ((1 << n_children_) - 1);
+#else
+  int mask = 0;
+  for (int i = 0; i < n_children_; ++i) {
+    mask |= (keys_[i] > partial_key) << i;
+  }
+  return mask;
+#endif
+}
+
+} // namespace art
+
+#endif
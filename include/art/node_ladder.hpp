@@ -0,0 +1,190 @@
+/**
+ * @file node ladder header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_NODE_LADDER_HPP
+#define ART_NODE_LADDER_HPP
+
+#include "inner_node.hpp"
+#include "node.hpp"
+#include "node_16.hpp"
+#include "node_256.hpp"
+#include "node_4.hpp"
+#include "node_48.hpp"
+#include "node_8.hpp"
+#include <stdexcept>
+
+namespace art {
+
+/**
+ * Determines if the node class of type from implements grow (or shrink) to
+ * the node class of type to itself, other transitions move the children one
+ * by one.
+ */
+constexpr bool native_grow(node_type from, node_type to) {
+  return (from == node_type::node_4 && to == node_type::node_16) ||
+         (from == node_type::node_8 && to == node_type::node_16) ||
+         (from == node_type::node_16 && to == node_type::node_48) ||
+         (from == node_type::node_48 && to == node_type::node_256);
+}
+
+constexpr bool native_shrink(node_type from, node_type to) {
+  return (from == node_type::node_8 && to == node_type::node_4) ||
+         (from == node_type::node_16 && to == node_type::node_4) ||
+         (from == node_type::node_48 && to == node_type::node_16) ||
+         (from == node_type::node_256 && to == node_type::node_48);
+}
+
+/**
+ * Replaces the node with a node of class To holding the same prefix and
+ * children, the node is deleted.
+ */
+template <template <class> class To, class T>
+inner_node<T> *transfer(inner_node<T> *from) {
+  auto to = new To<T>();
+  to->prefix_ = from->prefix_;
+  to->prefix_len_ = from->prefix_len_;
+  for (auto it = from->begin(), it_end = from->end(); it != it_end; ++it) {
+    to->set_child(it.get_partial_key(), it.get_child_node());
+  }
+  delete from;
+  return to;
+}
+
+template <template <class> class... Nodes> struct ladder_steps;
+
+/**
+ * Largest node class of a ladder.
+ */
+template <template <class> class Node> struct ladder_steps<Node> {
+  static_assert(Node<int>::CAPACITY == 256,
+                "the largest node class holds all 256 partial keys");
+
+  template <class T> static inner_node<T> *grow(inner_node<T> *) {
+    throw std::runtime_error("the largest node cannot grow");
+  }
+
+  template <class T> static inner_node<T> *shrink(inner_node<T> *) {
+    throw std::runtime_error("node type not in ladder");
+  }
+
+  static int smaller_capacity(node_type) { return 0; }
+
+  static bool contains(node_type type) { return type == Node<int>::TYPE; }
+
+  template <class T> static inner_node<T> *make(node_type, int) {
+    return new Node<T>();
+  }
+};
+
+/**
+ * Transitions between Node and the next larger node class Next, the rest of
+ * the ladder is handled recursively.
+ */
+template <template <class> class Node, template <class> class Next,
+          template <class> class... Rest>
+struct ladder_steps<Node, Next, Rest...> {
+  static_assert(Node<int>::CAPACITY < Next<int>::CAPACITY,
+                "node classes are ordered by capacity");
+
+  typedef ladder_steps<Next, Rest...> rest;
+
+  template <class T> static inner_node<T> *grow(inner_node<T> *n) {
+    if (n->type() != Node<T>::TYPE) {
+      return rest::grow(n);
+    }
+    return native_grow(Node<T>::TYPE, Next<T>::TYPE) ? n->grow()
+                                                     : transfer<Next>(n);
+  }
+
+  template <class T> static inner_node<T> *shrink(inner_node<T> *n) {
+    if (n->type() != Next<T>::TYPE) {
+      return rest::shrink(n);
+    }
+    return native_shrink(Next<T>::TYPE, Node<T>::TYPE) ? n->shrink()
+                                                       : transfer<Node>(n);
+  }
+
+  static int smaller_capacity(node_type type) {
+    return type == Next<int>::TYPE ? Node<int>::CAPACITY
+                                   : rest::smaller_capacity(type);
+  }
+
+  static bool contains(node_type type) {
+    return type == Node<int>::TYPE || rest::contains(type);
+  }
+
+  template <class T> static inner_node<T> *make(node_type type, int n_children) {
+    if (type == Node<T>::TYPE ||
+        (!contains(type) && n_children <= Node<T>::CAPACITY)) {
+      return new Node<T>();
+    }
+    return rest::template make<T>(type, n_children);
+  }
+};
+
+/**
+ * Inner node classes of a tree in ascending capacity, art::set grows a full
+ * node into the next class and art::del shrinks a node into the previous
+ * one, as decided by the shrink policy. The smallest class, which holds the
+ * two children of a split, needs room for at least two children, the largest
+ * one for all 256 partial keys.
+ *
+ * For example, node_ladder<node_4, node_8, node_16, node_48, node_256> adds
+ * a size class for a fanout of 5 to 8 and node_ladder<node_16, node_48,
+ * node_256> skips node_4.
+ */
+template <template <class> class First, template <class> class... Rest>
+struct node_ladder {
+  static_assert(First<int>::CAPACITY >= 2,
+                "the smallest node class holds the two children of a split");
+
+  typedef ladder_steps<First, Rest...> steps;
+
+  /**
+   * New inner node of the smallest class.
+   */
+  template <class T> static inner_node<T> *make_smallest() {
+    return new First<T>();
+  }
+
+  /**
+   * Replaces a full node with a node of the next larger class.
+   */
+  template <class T> static inner_node<T> *grow(inner_node<T> *n) {
+    return steps::grow(n);
+  }
+
+  /**
+   * Replaces a node with a node of the next smaller class, the node's
+   * children must fit.
+   */
+  template <class T> static inner_node<T> *shrink(inner_node<T> *n) {
+    return steps::shrink(n);
+  }
+
+  /**
+   * Capacity of the class a node of the given type shrinks into, 0 if it is
+   * the smallest class.
+   */
+  static int smaller_capacity(node_type type) {
+    return steps::smaller_capacity(type);
+  }
+
+  /**
+   * New inner node of the given type if the ladder has such a class, else of
+   * the smallest class holding n_children, e.g., when loading a tree which
+   * was saved with another ladder.
+   */
+  template <class T>
+  static inner_node<T> *make(node_type type, int n_children) {
+    return steps::template make<T>(type, n_children);
+  }
+};
+
+typedef node_ladder<node_4, node_16, node_48, node_256> default_ladder;
+
+} // namespace art
+
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file serialization helpers header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_SERIALIZATION_HPP
+#define ART_SERIALIZATION_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace art {
+
+/**
+ * Value codec which writes the raw bytes of trivially copyable values.
+ * Custom codecs must provide the same two methods.
+ */
+template <class T> class pod_codec {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "pod_codec requires a trivially copyable type");
+
+public:
+  void encode(std::ostream &out, const T &value) const;
+  T decode(std::istream &in) const;
+};
+
+template <class T>
+void pod_codec<T>::encode(std::ostream &out, const T &value) const {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <class T> T pod_codec<T>::decode(std::istream &in) const {
+  T value;
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::runtime_error("unexpected end of stream");
+  }
+  return value;
+}
+
+/**
+ * Writes an unsigned integer in little endian byte order.
+ */
+template <class U> void write_le(std::ostream &out, U value) {
+  char bytes[sizeof(U)];
+  for (unsigned i = 0; i < sizeof(U); ++i) {
+    bytes[i] = static_cast<char>(value >> (8 * i));
+  }
+  out.write(bytes, sizeof(U));
+}
+
+/**
+ * Reads an unsigned integer in little endian byte order.
+ *
+ * @throws std::runtime_error if the stream ends prematurely.
+ */
+template <class U> U read_le(std::istream &in) {
+  unsigned char bytes[sizeof(U)];
+  if (!in.read(reinterpret_cast<char *>(bytes), sizeof(U))) {
+    throw std::runtime_error("unexpected end of stream");
+  }
+  U value = 0;
+  for (unsigned i = 0; i < sizeof(U); ++i) {
+    value |= static_cast<U>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+} // namespace art
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file node shrink policies header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_SHRINK_POLICY_HPP
+#define ART_SHRINK_POLICY_HPP
+
+#include "node.hpp"
+#include <algorithm>
+
+namespace art {
+
+/**
+ * Shrink policy of art::del, an inner node shrinks to the next smaller node
+ * class of the tree's node_ladder once a delete leaves it with at most the
+ * given number of children, bounded by the capacity of the smaller class.
+ * A node grows only when it is full, so thresholds below the capacity of the
+ * smaller class leave room for inserts after a shrink, i.e., a node whose
+ * number of children oscillates around a capacity is not grown and shrunk on
+ * every insert and delete.
+ *
+ * @tparam Node16 - Shrinks node_16, e.g., to node_4.
+ * @tparam Node48 - Shrinks node_48, e.g., to node_16.
+ * @tparam Node256 - Shrinks node_256, e.g., to node_48.
+ * Other node classes shrink at half the capacity of the smaller class.
+ */
+template <int Node16, int Node48, int Node256> struct shrink_thresholds {
+  static_assert(Node16 >= 0 && Node48 >= 0 && Node256 >= 0,
+                "thresholds are numbers of children");
+
+  static bool should_shrink(node_type type, int n_children,
+                            int smaller_capacity) {
+    int threshold = type == node_type::node_16    ? Node16
+                    : type == node_type::node_48  ? Node48
+                    : type == node_type::node_256 ? Node256
+                                                  : smaller_capacity / 2;
+    return n_children <= std::min(threshold, smaller_capacity);
+  }
+};
+
+/**
+ * Shrinks as soon as the children fit into the smaller class.
+ */
+struct eager_shrink {
+  static bool should_shrink(node_type, int n_children, int smaller_capacity) {
+    return n_children <= smaller_capacity;
+  }
+};
+
+/**
+ * Shrinks at half the capacity of the smaller class, e.g., a node_16 at 2
+ * children.
+ */
+struct hysteresis_shrink {
+  static bool should_shrink(node_type, int n_children, int smaller_capacity) {
+    return n_children <= smaller_capacity / 2;
+  }
+};
+
+} // namespace art
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file vectorized byte kernels header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_SIMD_HPP
+#define ART_SIMD_HPP
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__i386__) || defined(__amd64__)
+#include <emmintrin.h>
+#if defined(__GNUC__) && !defined(ART_NO_CPU_DISPATCH)
+/* wider kernels compiled with target attributes, selected at run time */
+#define ART_CPU_DISPATCH 1
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__AVX2__) && !defined(ART_CPU_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace art {
+
+/**
+ * Instruction set extensions of the running CPU, detected once.
+ */
+struct cpu_features {
+  bool avx2_ = false;
+  bool avx512bw_ = false;
+};
+
+inline const cpu_features &detect_cpu_features() {
+  static const cpu_features features = []() {
+    cpu_features f;
+#if defined(ART_CPU_DISPATCH)
+    __builtin_cpu_init();
+    f.avx2_ = __builtin_cpu_supports("avx2");
+    f.avx512bw_ = __builtin_cpu_supports("avx512bw");
+#endif
+    return f;
+  }();
+  return features;
+}
+
+namespace detail {
+
+/**
+ * Baseline kernel of common_prefix_len, compares 32 bytes at a time if
+ * compiled with AVX2, 16 bytes with SSE2 and 8 bytes with SWAR on other
+ * platforms.
+ */
+inline int common_prefix_len_baseline(const char *a, const char *b, int len) {
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 32 <= len; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    uint32_t mismatches = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (mismatches != 0) {
+      return i + __builtin_ctz(mismatches);
+    }
+  }
+#endif
+#if defined(__i386__) || defined(__amd64__)
+  for (; i + 16 <= len; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    uint32_t mismatches =
+        ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) &
+        0xffff;
+    if (mismatches != 0) {
+      return i + __builtin_ctz(mismatches);
+    }
+  }
+#endif
+  for (; i + 8 <= len; i += 8) {
+    uint64_t x, y;
+    std::memcpy(&x, a + i, 8);
+    std::memcpy(&y, b + i, 8);
+    uint64_t mismatches = x ^ y;
+    if (mismatches != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      return i + __builtin_ctzll(mismatches) / 8;
+#else
+      return i + __builtin_clzll(mismatches) / 8;
+#endif
+    }
+  }
+  for (; i < len && a[i] == b[i]; ++i) {
+  }
+  return i;
+}
+
+#if defined(ART_CPU_DISPATCH)
+
+__attribute__((target("avx2"))) inline int
+common_prefix_len_avx2(const char *a, const char *b, int len) {
+  int i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    uint32_t mismatches = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (mismatches != 0) {
+      return i + __builtin_ctz(mismatches);
+    }
+  }
+  return i + common_prefix_len_baseline(a + i, b + i, len - i);
+}
+
+/**
+ * Compares 64 bytes at a time, the tail with a masked load, which does not
+ * read past len.
+ */
+__attribute__((target("avx512bw"))) inline int
+common_prefix_len_avx512(const char *a, const char *b, int len) {
+  int i = 0;
+  for (; i + 64 <= len; i += 64) {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = _mm512_loadu_si512(b + i);
+    uint64_t mismatches = ~_mm512_cmpeq_epi8_mask(x, y);
+    if (mismatches != 0) {
+      return i + __builtin_ctzll(mismatches);
+    }
+  }
+  if (i < len) {
+    __mmask64 tail = ~0ull >> (64 - (len - i));
+    __m512i x = _mm512_maskz_loadu_epi8(tail, a + i);
+    __m512i y = _mm512_maskz_loadu_epi8(tail, b + i);
+    uint64_t mismatches = ~_mm512_cmpeq_epi8_mask(x, y) & tail;
+    return mismatches != 0 ? i + __builtin_ctzll(mismatches) : len;
+  }
+  return i;
+}
+
+typedef int (*common_prefix_len_kernel)(const char *, const char *, int);
+
+inline common_prefix_len_kernel select_common_prefix_len() {
+  const cpu_features &cpu = detect_cpu_features();
+  if (cpu.avx512bw_) {
+    return common_prefix_len_avx512;
+  }
+  if (cpu.avx2_) {
+    return common_prefix_len_avx2;
+  }
+  return common_prefix_len_baseline;
+}
+
+#endif
+
+} // namespace detail
+
+/**
+ * Determines the number of leading bytes a and b have in common, comparing at
+ * most len bytes, i.e., neither a nor b is read past len.
+ * Ranges of at least 64 bytes are compared by an AVX-512 or AVX2 kernel if the
+ * CPU supports it, chosen once at run time. Define ART_NO_CPU_DISPATCH to
+ * only use the instruction sets enabled at compile time.
+ */
+inline int common_prefix_len(const char *a, const char *b, int len) {
+#if defined(ART_CPU_DISPATCH)
+  if (len >= 64) {
+    static const detail::common_prefix_len_kernel kernel =
+        detail::select_common_prefix_len();
+    return kernel(a, b, len);
+  }
+#endif
+  return detail::common_prefix_len_baseline(a, b, len);
+}
+
+/**
+ * Index of the first bit set at or after i in a 256-bit bitmap, or -1 if
+ * there is none.
+ */
+inline int bitmap_next(const uint64_t *bitmap, int i) {
+  int word = i >> 6;
+  uint64_t bits = bitmap[word] & (~0ull << (i & 63));
+  while (bits == 0) {
+    if (++word == 4) {
+      return -1;
+    }
+    bits = bitmap[word];
+  }
+  return 64 * word + __builtin_ctzll(bits);
+}
+
+/**
+ * Index of the last bit set at or before i in a 256-bit bitmap, or -1 if
+ * there is none.
+ */
+inline int bitmap_prev(const uint64_t *bitmap, int i) {
+  int word = i >> 6;
+  uint64_t bits = bitmap[word] & (~0ull >> (63 - (i & 63)));
+  while (bits == 0) {
+    if (--word < 0) {
+      return -1;
+    }
+    bits = bitmap[word];
+  }
+  return 64 * word + 63 - __builtin_clzll(bits);
+}
+
+} // namespace art
+
+#endif
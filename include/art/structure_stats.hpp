@@ -0,0 +1,93 @@
+/**
+ * @file structural statistics header
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#ifndef ART_STRUCTURE_STATS_HPP
+#define ART_STRUCTURE_STATS_HPP
+
+#include "node.hpp"
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace art {
+
+/**
+ * Shape of a tree, see art::structure_stats.
+ * A histogram's i-th entry counts the occurrences of value i, histograms end
+ * at the largest value observed.
+ */
+struct structure_stats {
+  /* leaves by number of nodes on the path from the root, root has depth 0 */
+  std::vector<uint64_t> leaf_depth_;
+
+  /* leaves by number of key bytes, including the terminating null byte */
+  std::vector<uint64_t> leaf_depth_bytes_;
+
+  /* inner nodes by number of children, indexed by node_type */
+  std::vector<uint64_t> fanout_[n_node_types];
+
+  /* nodes by prefix length */
+  std::vector<uint64_t> prefix_len_;
+
+  /* fraction of child slots used, 0 if there are no such nodes */
+  double node_48_utilization_ = 0;
+  double node_256_utilization_ = 0;
+
+  /**
+   * Serializes the statistics as a JSON object.
+   */
+  std::string to_json() const;
+
+  /**
+   * Increments the given histogram's entry, growing it if needed.
+   */
+  static void add(std::vector<uint64_t> &histogram, size_t value);
+};
+
+inline void structure_stats::add(std::vector<uint64_t> &histogram,
+                                 size_t value) {
+  if (histogram.size() <= value) {
+    histogram.resize(value + 1, 0);
+  }
+  ++histogram[value];
+}
+
+inline std::string structure_stats::to_json() const {
+  /* inner node types in ascending capacity */
+  static const node_type inner_types[] = {node_type::node_4, node_type::node_8,
+                                          node_type::node_16,
+                                          node_type::node_48,
+                                          node_type::node_256};
+  static const char *node_names[] = {"leaf_node", "node_4",   "node_16",
+                                     "node_48",   "node_256", "node_8"};
+  std::ostringstream out;
+  auto write_histogram = [&out](const std::vector<uint64_t> &histogram) {
+    out << '[';
+    for (size_t i = 0; i < histogram.size(); ++i) {
+      out << (i > 0 ? "," : "") << histogram[i];
+    }
+    out << ']';
+  };
+  out << "{\"leaf_depth\":";
+  write_histogram(leaf_depth_);
+  out << ",\"leaf_depth_bytes\":";
+  write_histogram(leaf_depth_bytes_);
+  out << ",\"fanout\":{";
+  for (int i = 0; i < 5; ++i) {
+    int type = static_cast<int>(inner_types[i]);
+    out << (i > 0 ? "," : "") << '"' << node_names[type] << "\":";
+    write_histogram(fanout_[type]);
+  }
+  out << "},\"prefix_len\":";
+  write_histogram(prefix_len_);
+  out << ",\"node_48_utilization\":" << node_48_utilization_
+      << ",\"node_256_utilization\":" << node_256_utilization_ << '}';
+  return out.str();
+}
+
+} // namespace art
+
+#endif
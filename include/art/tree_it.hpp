@@ -204,7 +204,9 @@ template <class T> tree_it<T> tree_it<T>::min(node<T> *root) {
 
 template <class T>
 tree_it<T> tree_it<T>::greater_equal(node<T> *root, const char *key) {
-  assert(root != nullptr);
+  if (root == nullptr) {
+    return tree_it<T>();
+  }
 
   int key_len = std::strlen(key);
   std::vector<tree_it<T>::step> traversal_stack;
@@ -217,7 +219,8 @@ tree_it<T> tree_it<T>::greater_equal(node<T> *root, const char *key) {
     node<T> *cur_node = cur_step.child_node_;
     int cur_depth = cur_step.depth_;
 
-    int prefix_match_len = std::min<int>(cur_node->check_prefix(key + cur_depth, key_len - cur_depth), key_len - cur_depth);
+    int prefix_match_len =
+        cur_node->check_prefix(key + cur_depth, key_len - cur_depth);
     // if search key "equals" the prefix
     if (key_len == cur_depth + prefix_match_len) {
         return tree_it<T>(root, traversal_stack);
@@ -247,6 +250,10 @@ tree_it<T> tree_it<T>::greater_equal(node<T> *root, const char *key) {
     std::copy_n(cur_node->prefix_, cur_node->prefix_len_, child.key_ + cur_depth);
     child.key_[cur_depth + cur_node->prefix_len_] = c_it.get_partial_key();
     traversal_stack.push_back(child);
+    if (c_it == c_it_end) {
+      /* search key is greater than all children, continue after the node */
+      return tree_it<T>(root, traversal_stack);
+    }
   }
 }
 
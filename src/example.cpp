@@ -1,11 +1,14 @@
 #include "art.hpp"
+#include "dataset.hpp"
 #include "zipf.hpp"
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <chrono>
 #include <thread>
 #include <memory>
@@ -13,14 +16,8 @@
 using std::string;
 
 void art_bench() {
-  std::ifstream file("dataset.txt");
-  std::unordered_map<uint32_t, string> dataset;
-  uint32_t n = 0;
-  string line;
-  while (std::getline(file, line)) {
-    dataset[n++] = line;
-  }
-  file.close();
+  std::vector<string> keys = dataset::load_or_generate("dataset.txt", 1000000, 0);
+  uint32_t n = keys.size();
 
   fast_zipf rng(n);
   art::art<int*> m;
@@ -29,9 +26,9 @@ void art_bench() {
   int v = 1;
   std::mt19937_64 g(0);
   for (uint32_t i = 0; i < 1000000; ++i) {
-    auto k = dataset[rng()];
+    auto k = keys[std::min(rng(), n - 1)];
     m.set(k.c_str(), &v);
-    /* m[dataset[rng()]] = &v; */
+    /* m[keys[std::min(rng(), n - 1)]] = &v; */
   }
 }
 
@@ -8,8 +8,11 @@
 #include <algorithm>
 #include <array>
 #include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
 
 using std::array;
@@ -310,4 +313,479 @@ TEST_SUITE("art") {
       delete del_res;
     }
   }
+
+  TEST_CASE("batch get") {
+    art::art<int> m;
+    mt19937_64 rng(0);
+    std::vector<string> keys;
+    for (int i = 0; i < 5000; ++i) {
+      keys.push_back(to_string(rng() % 100000));
+      m.set(keys.back().c_str(), i + 1);
+    }
+    /* misses: absent keys, prefixes of keys and the empty key */
+    for (int i = 0; i < 1000; ++i) {
+      keys.push_back(to_string(rng() % 1000000));
+    }
+    keys.push_back("1");
+    keys.push_back("");
+    shuffle(keys.begin(), keys.end(), rng);
+    std::vector<const char *> key_ptrs;
+    for (const string &key : keys) {
+      key_ptrs.push_back(key.c_str());
+    }
+
+    SUBCASE("matches get") {
+      for (size_t n : {size_t(0), size_t(1), size_t(15), size_t(17), keys.size()}) {
+        std::vector<int> values(n, -1);
+        m.get_batch(key_ptrs.data(), n, values.data());
+        for (size_t i = 0; i < n; ++i) {
+          REQUIRE_EQ(m.get(key_ptrs[i]), values[i]);
+        }
+      }
+    }
+
+    SUBCASE("empty tree") {
+      art::art<int> empty;
+      std::vector<int> values(keys.size(), -1);
+      empty.get_batch(key_ptrs.data(), keys.size(), values.data());
+      for (int value : values) {
+        REQUIRE_EQ(0, value);
+      }
+    }
+  }
+
+  TEST_CASE("shrink thresholds") {
+    using art::node_type;
+
+    SUBCASE("eager shrink") {
+      art::art<int, art::no_counters, art::eager_shrink> m;
+      for (int i = 0; i < 5; ++i) {
+        m.set(to_string(i).c_str(), i + 1);
+      }
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_16].count_);
+      m.del("4");
+      REQUIRE_EQ(0, m.memory_stats()[node_type::node_16].count_);
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_4].count_);
+    }
+
+    SUBCASE("hysteresis") {
+      art::art<int> m;
+      for (int i = 0; i < 5; ++i) {
+        m.set(to_string(i).c_str(), i + 1);
+      }
+      /* oscillating around 4 children neither grows nor shrinks */
+      for (int round = 0; round < 3; ++round) {
+        m.del("4");
+        REQUIRE_EQ(1, m.memory_stats()[node_type::node_16].count_);
+        m.set("4", 5);
+        REQUIRE_EQ(1, m.memory_stats()[node_type::node_16].count_);
+      }
+      m.del("4");
+      m.del("3");
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_16].count_);
+      m.del("2");
+      REQUIRE_EQ(0, m.memory_stats()[node_type::node_16].count_);
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_4].count_);
+      REQUIRE_EQ(1, m.get("0"));
+      REQUIRE_EQ(2, m.get("1"));
+    }
+
+    SUBCASE("hysteresis at every node type") {
+      art::art<int> m;
+      /* one child per partial key below "a", "a" itself is the child at 0 */
+      for (int i = 0; i < 256; ++i) {
+        m.set((string("a") + (char)(i - 128) + "b").c_str(), i + 1);
+      }
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_256].count_);
+      int i = 255;
+      for (; i >= 24; --i) {
+        m.del((string("a") + (char)(i - 128) + "b").c_str());
+      }
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_48].count_);
+      for (; i >= 8; --i) {
+        m.del((string("a") + (char)(i - 128) + "b").c_str());
+      }
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_16].count_);
+      for (; i >= 2; --i) {
+        m.del((string("a") + (char)(i - 128) + "b").c_str());
+      }
+      REQUIRE_EQ(1, m.memory_stats()[node_type::node_4].count_);
+      REQUIRE_EQ(1, m.get((string("a") + (char)-128 + "b").c_str()));
+      REQUIRE_EQ(2, m.get((string("a") + (char)-127 + "b").c_str()));
+    }
+  }
+
+  TEST_CASE("node ladders") {
+    using art::node_type;
+    typedef art::node_ladder<art::node_4, art::node_8, art::node_16,
+                             art::node_48, art::node_256>
+        with_node_8;
+    typedef art::node_ladder<art::node_16, art::node_48, art::node_256>
+        without_node_4;
+    typedef art::node_ladder<art::node_4, art::node_256> two_classes;
+
+    mt19937_64 g(0);
+    std::vector<string> keys;
+    for (int i = 0; i < 2000; ++i) {
+      /* a wide first and narrow further bytes, so nodes of every fanout
+       * occur */
+      string key(1, static_cast<char>('0' + g() % 64));
+      for (int len = g() % 3; len > 0; --len) {
+        key += static_cast<char>('0' + g() % 8);
+      }
+      keys.push_back(key);
+    }
+
+    art::art<int, art::no_counters, art::hysteresis_shrink, with_node_8> m8;
+    art::art<int, art::no_counters, art::eager_shrink, without_node_4> m16;
+    art::art<int, art::no_counters, art::hysteresis_shrink, two_classes> m2;
+    std::map<string, int> reference;
+    for (int i = 0; i < 20000; ++i) {
+      const string &key = keys[g() % keys.size()];
+      if (g() % 3 == 0) {
+        reference.erase(key);
+        m8.del(key.c_str());
+        m16.del(key.c_str());
+        m2.del(key.c_str());
+      } else {
+        reference[key] = i + 1;
+        m8.set(key.c_str(), i + 1);
+        m16.set(key.c_str(), i + 1);
+        m2.set(key.c_str(), i + 1);
+      }
+    }
+
+    for (const string &key : keys) {
+      auto it = reference.find(key);
+      int expected = it == reference.end() ? 0 : it->second;
+      REQUIRE_EQ(expected, m8.get(key.c_str()));
+      REQUIRE_EQ(expected, m16.get(key.c_str()));
+      REQUIRE_EQ(expected, m2.get(key.c_str()));
+    }
+    auto reference_it = reference.begin();
+    for (auto it = m8.begin(), it_end = m8.end(); it != it_end; ++it) {
+      REQUIRE(reference_it != reference.end());
+      REQUIRE_EQ(reference_it->first, it.key());
+      ++reference_it;
+    }
+    REQUIRE(reference_it == reference.end());
+
+    /* only the ladder's classes are used */
+    REQUIRE_GT(m8.memory_stats()[node_type::node_8].count_, 0);
+    REQUIRE_EQ(0, m16.memory_stats()[node_type::node_4].count_);
+    REQUIRE_EQ(0, m16.memory_stats()[node_type::node_8].count_);
+    REQUIRE_EQ(0, m2.memory_stats()[node_type::node_16].count_);
+    REQUIRE_EQ(0, m2.memory_stats()[node_type::node_48].count_);
+    REQUIRE_EQ(reference.size(), m8.memory_stats().n_keys());
+    REQUIRE_EQ(reference.size(), m2.memory_stats().n_keys());
+
+    SUBCASE("load a tree saved with another ladder") {
+      std::stringstream stream;
+      m8.save(stream);
+      art::art<int> loaded;
+      loaded.load(stream);
+      /* a node_8 becomes a node_4 or node_16, whichever holds its children */
+      auto saved = m8.memory_stats(), loaded_stats = loaded.memory_stats();
+      REQUIRE_EQ(0, loaded_stats[node_type::node_8].count_);
+      REQUIRE_EQ(saved[node_type::node_4].count_ +
+                     saved[node_type::node_8].count_ +
+                     saved[node_type::node_16].count_,
+                 loaded_stats[node_type::node_4].count_ +
+                     loaded_stats[node_type::node_16].count_);
+      for (const auto &entry : reference) {
+        REQUIRE_EQ(entry.second, loaded.get(entry.first.c_str()));
+      }
+
+      std::stringstream stream2;
+      loaded.save(stream2);
+      m2.load(stream2);
+      REQUIRE_EQ(0, m2.memory_stats()[node_type::node_16].count_);
+      for (const auto &entry : reference) {
+        REQUIRE_EQ(entry.second, m2.get(entry.first.c_str()));
+        REQUIRE_EQ(entry.second, m2.del(entry.first.c_str()));
+      }
+      REQUIRE_EQ(0, m2.memory_stats().n_keys());
+    }
+  }
+
+  TEST_CASE("snapshot") {
+    art::art<int*> m;
+    int values[1000];
+    for (int i = 0; i < 1000; ++i) {
+      m.set(to_string(i).c_str(), &values[i]);
+    }
+
+    SUBCASE("snapshot is not affected by subsequent writes") {
+      auto snap = m.snapshot();
+      for (int i = 0; i < 1000; i += 2) {
+        REQUIRE(m.del(to_string(i).c_str()) == &values[i]);
+      }
+      for (int i = 1; i < 1000; i += 2) {
+        m.set(to_string(i).c_str(), &values[0]);
+      }
+      m.set("new", &values[1]);
+      for (int i = 0; i < 1000; ++i) {
+        REQUIRE_EQ(&values[i], snap.get(to_string(i).c_str()));
+        REQUIRE_EQ(i % 2 == 0 ? nullptr : &values[0],
+                   m.get(to_string(i).c_str()));
+      }
+      REQUIRE_EQ(nullptr, snap.get("new"));
+      REQUIRE_EQ(&values[1], m.get("new"));
+    }
+
+    SUBCASE("writes copy only the modified path") {
+      auto snap = m.snapshot();
+      m.set("500", &values[0]);
+      int n_keys = 0;
+      for (auto it = snap.begin(), it_end = snap.end(); it != it_end; ++it) {
+        REQUIRE_EQ(&values[std::stoi(it.key())], *it);
+        ++n_keys;
+      }
+      REQUIRE_EQ(1000, n_keys);
+      REQUIRE_EQ(&values[0], m.get("500"));
+      REQUIRE_EQ(&values[1], m.get("1"));
+    }
+
+    SUBCASE("tree outlives snapshot") {
+      {
+        auto snap = m.snapshot();
+        for (int i = 0; i < 1000; ++i) {
+          m.del(to_string(i).c_str());
+        }
+        REQUIRE_EQ(&values[999], snap.get("999"));
+      }
+      REQUIRE_EQ(nullptr, m.get("999"));
+      m.set("999", &values[999]);
+      REQUIRE_EQ(&values[999], m.get("999"));
+    }
+
+    SUBCASE("snapshot outlives tree") {
+      art::art<int*> *tree = new art::art<int*>();
+      tree->set("abc", &values[0]);
+      tree->set("abd", &values[1]);
+      auto snap = tree->snapshot();
+      tree->del("abc");
+      delete tree;
+      REQUIRE_EQ(&values[0], snap.get("abc"));
+      REQUIRE_EQ(&values[1], snap.get("abd"));
+    }
+
+    SUBCASE("snapshots of snapshots") {
+      auto snap1 = m.snapshot();
+      m.del("1");
+      auto snap2 = m.snapshot();
+      m.del("2");
+      art::art<int*> copy = snap2;
+      copy.del("3");
+      REQUIRE_EQ(&values[1], snap1.get("1"));
+      REQUIRE_EQ(&values[2], snap1.get("2"));
+      REQUIRE_EQ(nullptr, snap2.get("1"));
+      REQUIRE_EQ(&values[2], snap2.get("2"));
+      REQUIRE_EQ(&values[3], snap2.get("3"));
+      REQUIRE_EQ(nullptr, m.get("2"));
+      REQUIRE_EQ(&values[3], m.get("3"));
+      REQUIRE_EQ(nullptr, copy.get("3"));
+    }
+  }
+
+  TEST_CASE("save and load") {
+    art::art<int> m;
+    mt19937_64 rng(0);
+    std::vector<string> keys;
+    for (int i = 0; i < 10000; ++i) {
+      keys.push_back(to_string(rng()));
+      m.set(keys.back().c_str(), i + 1);
+    }
+    /* a few dense nodes and deep single paths */
+    for (int i = 1; i < 256; ++i) {
+      keys.push_back(string("dense") + (char)i);
+      m.set(keys.back().c_str(), i + 1);
+    }
+    keys.push_back(string(1000, 'x'));
+    m.set(keys.back().c_str(), 1);
+
+    std::stringstream stream;
+    m.save(stream);
+
+    SUBCASE("round trip") {
+      art::art<int> loaded;
+      loaded.set("replaced", 1);
+      loaded.load(stream);
+      REQUIRE_EQ(0, loaded.get("replaced"));
+      for (const auto &k : keys) {
+        REQUIRE_EQ(m.get(k.c_str()), loaded.get(k.c_str()));
+      }
+      auto it = m.begin(), it_end = m.end();
+      auto loaded_it = loaded.begin(), loaded_it_end = loaded.end();
+      for (; it != it_end; ++it, ++loaded_it) {
+        REQUIRE(loaded_it != loaded_it_end);
+        REQUIRE_EQ(it.key(), loaded_it.key());
+        REQUIRE_EQ(*it, *loaded_it);
+      }
+      REQUIRE(loaded_it == loaded_it_end);
+
+      /* loaded tree is fully functional */
+      for (const auto &k : keys) {
+        REQUIRE_NE(0, loaded.del(k.c_str()));
+      }
+      REQUIRE_EQ(0, loaded.get(keys[0].c_str()));
+    }
+
+    SUBCASE("empty tree") {
+      art::art<int> empty, loaded;
+      std::stringstream empty_stream;
+      empty.save(empty_stream);
+      loaded.set("abc", 1);
+      loaded.load(empty_stream);
+      REQUIRE_EQ(0, loaded.get("abc"));
+      loaded.set("abc", 2);
+      REQUIRE_EQ(2, loaded.get("abc"));
+    }
+
+    SUBCASE("custom codec") {
+      struct string_codec {
+        void encode(std::ostream &out, const string &value) const {
+          art::write_le<uint32_t>(out, value.size());
+          out.write(value.data(), value.size());
+        }
+        string decode(std::istream &in) const {
+          string value(art::read_le<uint32_t>(in), 0);
+          in.read(&value[0], value.size());
+          return value;
+        }
+      };
+      art::art<string> strings;
+      for (int i = 0; i < 1000; ++i) {
+        strings.set(to_string(i).c_str(), "value" + to_string(i));
+      }
+      std::stringstream string_stream;
+      strings.save(string_stream, string_codec());
+      art::art<string> loaded;
+      loaded.load(string_stream, string_codec());
+      for (int i = 0; i < 1000; ++i) {
+        REQUIRE_EQ("value" + to_string(i), loaded.get(to_string(i).c_str()));
+      }
+    }
+
+    SUBCASE("corrupt input") {
+      string bytes = stream.str();
+      art::art<int> loaded;
+      loaded.set("abc", 1);
+
+      std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+      REQUIRE_THROWS_AS(loaded.load(truncated), std::runtime_error);
+
+      std::stringstream bad_magic("XXXX" + bytes.substr(4));
+      REQUIRE_THROWS_AS(loaded.load(bad_magic), std::runtime_error);
+
+      bytes[9] = 42; // root node type
+      std::stringstream bad_type(bytes);
+      REQUIRE_THROWS_AS(loaded.load(bad_type), std::runtime_error);
+
+      REQUIRE_EQ(1, loaded.get("abc"));
+    }
+  }
+
+  TEST_CASE("memory stats") {
+    art::art<int> m;
+    auto empty = m.memory_stats();
+    REQUIRE_EQ(0, empty.n_keys());
+    REQUIRE_EQ(0, empty.total_bytes_);
+    REQUIRE_EQ(0, empty.bytes_per_key_);
+
+    /* the counts of a tree rebuilt by load are computed independently */
+    auto require_consistent = [](const art::art<int> &tree) {
+      std::stringstream stream;
+      tree.save(stream);
+      art::art<int> loaded;
+      loaded.load(stream);
+      auto stats = tree.memory_stats(), expected = loaded.memory_stats();
+      for (int i = 0; i < 5; ++i) {
+        REQUIRE_EQ(expected.nodes_[i].count_, stats.nodes_[i].count_);
+        REQUIRE_EQ(expected.nodes_[i].children_, stats.nodes_[i].children_);
+        REQUIRE_EQ(expected.nodes_[i].bytes_, stats.nodes_[i].bytes_);
+      }
+      REQUIRE_EQ(expected.prefix_bytes_, stats.prefix_bytes_);
+      REQUIRE_EQ(expected.slack_bytes_, stats.slack_bytes_);
+      REQUIRE_EQ(expected.total_bytes_, stats.total_bytes_);
+    };
+
+    mt19937_64 rng(0);
+    std::vector<string> keys;
+    for (int i = 0; i < 20000; ++i) {
+      keys.push_back(to_string(rng() % 100000));
+      m.set(keys.back().c_str(), i + 1);
+    }
+    for (int i = 1; i < 256; ++i) {
+      keys.push_back(string("dense") + (char)i);
+      m.set(keys.back().c_str(), i);
+    }
+    require_consistent(m);
+    auto stats = m.memory_stats();
+    REQUIRE(stats[art::node_type::node_256].count_ > 0);
+    REQUIRE(stats.slack_bytes_ > 0);
+    REQUIRE(stats.bytes_per_key_ > 0);
+
+    SUBCASE("after deletes") {
+      auto snapshot = m.snapshot();
+      std::shuffle(keys.begin(), keys.end(), rng);
+      for (size_t i = 0; i < keys.size(); ++i) {
+        m.del(keys[i].c_str());
+        if (i % 5000 == 0) {
+          require_consistent(m);
+        }
+      }
+      REQUIRE_EQ(0, m.memory_stats().n_keys());
+      REQUIRE_EQ(0, m.memory_stats().total_bytes_);
+      require_consistent(snapshot);
+    }
+
+    SUBCASE("copy and move") {
+      art::art<int> copy(m);
+      REQUIRE_EQ(stats.total_bytes_, copy.memory_stats().total_bytes_);
+      art::art<int> moved(std::move(copy));
+      REQUIRE_EQ(stats.total_bytes_, moved.memory_stats().total_bytes_);
+      REQUIRE_EQ(0, copy.memory_stats().total_bytes_);
+    }
+  }
+
+  TEST_CASE("structure stats") {
+    art::art<int> m;
+    auto empty = m.structure_stats();
+    REQUIRE(empty.leaf_depth_.empty());
+    REQUIRE_EQ("{\"leaf_depth\":[],\"leaf_depth_bytes\":[],\"fanout\":{\"node_4\":[],"
+               "\"node_8\":[],\"node_16\":[],\"node_48\":[],\"node_256\":[]},\"prefix_len\":[],"
+               "\"node_48_utilization\":0,\"node_256_utilization\":0}",
+               empty.to_json());
+
+    /*
+     *        (a)
+     *   a /   | b  \ c
+     *  (a\0) (\0)  (\0)
+     */
+    m.set("aaa", 1);
+    m.set("ab", 2);
+    m.set("ac", 3);
+    auto stats = m.structure_stats();
+    REQUIRE_EQ((std::vector<uint64_t>{0, 3}), stats.leaf_depth_);
+    REQUIRE_EQ((std::vector<uint64_t>{0, 0, 0, 2, 1}), stats.leaf_depth_bytes_);
+    REQUIRE_EQ((std::vector<uint64_t>{0, 0, 0, 1}),
+               stats.fanout_[static_cast<int>(art::node_type::node_4)]);
+    REQUIRE_EQ((std::vector<uint64_t>{0, 3, 1}), stats.prefix_len_);
+
+    for (int i = 1; i < 128; ++i) {
+      m.set((string("ab") + (char)i).c_str(), i);
+    }
+    for (int i = 0; i < 24; ++i) {
+      m.set((string("ac") + (char)('A' + i)).c_str(), i);
+    }
+    stats = m.structure_stats();
+    REQUIRE_EQ(128.0 / 256, stats.node_256_utilization_);
+    REQUIRE_EQ(25.0 / 48, stats.node_48_utilization_);
+    uint64_t n_leaves = 0;
+    for (auto n : stats.leaf_depth_) {
+      n_leaves += n;
+    }
+    REQUIRE_EQ(3 + 127 + 24, n_leaves);
+  }
 }
@@ -0,0 +1,122 @@
+/**
+ * @file set mode tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+
+TEST_SUITE("art set") {
+
+  TEST_CASE("insert, contains and erase") {
+    art::art<void> s;
+    REQUIRE_FALSE(s.contains("a"));
+    REQUIRE(s.insert("a"));
+    REQUIRE_FALSE(s.insert("a"));
+    REQUIRE(s.insert("ab"));
+    REQUIRE(s.insert(""));
+    REQUIRE_EQ(3, s.size());
+    REQUIRE(s.contains("a"));
+    REQUIRE(s.contains("ab"));
+    REQUIRE(s.contains(""));
+    REQUIRE_FALSE(s.contains("abc"));
+    REQUIRE_FALSE(s.erase("abc"));
+    REQUIRE(s.erase("a"));
+    REQUIRE_FALSE(s.erase("a"));
+    REQUIRE_FALSE(s.contains("a"));
+    REQUIRE(s.contains("ab"));
+    REQUIRE_EQ(2, s.size());
+  }
+
+  TEST_CASE("matches a reference set") {
+    art::art<void> s;
+    std::set<string> reference;
+    mt19937_64 rng(0);
+    for (int i = 0; i < 100000; ++i) {
+      string key = to_string(rng() % 20000);
+      if (rng() % 3 == 0) {
+        REQUIRE_EQ(reference.erase(key) == 1, s.erase(key.c_str()));
+      } else {
+        REQUIRE_EQ(reference.insert(key).second, s.insert(key.c_str()));
+      }
+    }
+    REQUIRE_EQ(reference.size(), s.size());
+    for (int i = 0; i < 20000; ++i) {
+      string key = to_string(i);
+      REQUIRE_EQ(reference.count(key) == 1, s.contains(key.c_str()));
+    }
+
+    SUBCASE("ordered iteration yields the keys") {
+      auto reference_it = reference.begin();
+      for (auto it = s.begin(), it_end = s.end(); it != it_end; ++it) {
+        REQUIRE(reference_it != reference.end());
+        REQUIRE_EQ(*reference_it, *it);
+        ++reference_it;
+      }
+      REQUIRE(reference_it == reference.end());
+    }
+
+    SUBCASE("iteration from a key") {
+      for (const char *key : {"", "1", "12345", "5", "9999", "a"}) {
+        auto reference_it = reference.lower_bound(key);
+        auto it = s.begin(key);
+        if (reference_it == reference.end()) {
+          REQUIRE(it == s.end());
+        } else {
+          REQUIRE(it != s.end());
+          REQUIRE_EQ(*reference_it, *it);
+        }
+      }
+    }
+
+    SUBCASE("snapshot") {
+      auto snap = s.snapshot();
+      for (const string &key : reference) {
+        s.erase(key.c_str());
+      }
+      REQUIRE_EQ(0, s.size());
+      REQUIRE_EQ(reference.size(), snap.size());
+      for (const string &key : reference) {
+        REQUIRE(snap.contains(key.c_str()));
+      }
+    }
+
+    SUBCASE("save and load") {
+      std::stringstream stream;
+      s.save(stream);
+      art::art<void> loaded;
+      loaded.insert("replaced");
+      loaded.load(stream);
+      REQUIRE_FALSE(loaded.contains("replaced"));
+      REQUIRE_EQ(reference.size(), loaded.size());
+      for (const string &key : reference) {
+        REQUIRE(loaded.contains(key.c_str()));
+      }
+    }
+  }
+
+  TEST_CASE("leaves store no value") {
+    art::art<void> s;
+    art::art<int *> m;
+    for (int i = 0; i < 1000; ++i) {
+      s.insert(to_string(i).c_str());
+      m.set(to_string(i).c_str(), nullptr);
+    }
+    auto set_stats = s.memory_stats(), map_stats = m.memory_stats();
+    REQUIRE_EQ(map_stats.n_keys(), set_stats.n_keys());
+    REQUIRE_LT(set_stats[art::node_type::leaf].bytes_,
+               map_stats[art::node_type::leaf].bytes_);
+    REQUIRE_EQ(map_stats.total_bytes_ - set_stats.total_bytes_,
+               1000 * (sizeof(art::leaf_node<int *>) -
+                       sizeof(art::leaf_node<art::no_value>)));
+  }
+}
@@ -0,0 +1,113 @@
+/**
+ * @file operation counters tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using art::counter;
+using std::string;
+using std::to_string;
+
+TEST_SUITE("counters") {
+
+  TEST_CASE("no counters") {
+    REQUIRE_EQ(sizeof(art::art<int>), sizeof(art::art<int, art::no_counters>));
+  }
+
+  TEST_CASE("structural cases") {
+    art::thread_counters::reset();
+    art::art<int, art::thread_counters> m;
+
+    m.set("aaa", 1); // root
+    m.set("aaa", 2); // replace
+    m.set("aab", 3); // split
+    m.set("aac", 4); // new child
+    m.set("aad", 5); // new child
+    m.set("aae", 6); // new child, grow
+    auto values = art::thread_counters::read();
+    REQUIRE_EQ(1, values[counter::set_root]);
+    REQUIRE_EQ(1, values[counter::set_replace]);
+    REQUIRE_EQ(1, values[counter::set_split]);
+    REQUIRE_EQ(3, values[counter::set_new_child]);
+    REQUIRE_EQ(1, values[counter::set_grow]);
+
+    REQUIRE_EQ(2, m.get("aaa"));
+    REQUIRE_EQ(0, m.get("aaf"));
+    REQUIRE_EQ(0, m.get("b"));
+    values = art::thread_counters::read();
+    REQUIRE_EQ(1, values[counter::get_hit]);
+    REQUIRE_EQ(2, values[counter::get_miss]);
+
+    REQUIRE_EQ(0, m.del("aaf")); // miss
+    m.del("aae");                // child
+    m.del("aad");                // child
+    /* hysteresis_shrink keeps the node_16 until 2 children are left */
+    REQUIRE_EQ(0, art::thread_counters::read()[counter::del_shrink]);
+    m.del("aac");                // child, shrink
+    REQUIRE_EQ(1, art::thread_counters::read()[counter::del_shrink]);
+    m.del("aab");                // merge
+    m.del("aaa");                // root
+    REQUIRE_EQ(0, m.del("aaa")); // miss on empty tree
+    values = art::thread_counters::read();
+    REQUIRE_EQ(2, values[counter::del_miss]);
+    REQUIRE_EQ(3, values[counter::del_child]);
+    REQUIRE_EQ(1, values[counter::del_shrink]);
+    REQUIRE_EQ(1, values[counter::del_merge]);
+    REQUIRE_EQ(1, values[counter::del_root]);
+
+    REQUIRE_EQ(6 + 3 + 7, values.n_operations());
+    REQUIRE(values.nodes_per_operation() > 1);
+
+    art::thread_counters::reset();
+    REQUIRE_EQ(0, art::thread_counters::read().n_operations());
+  }
+
+  TEST_CASE("batch get counts like get") {
+    art::art<int, art::thread_counters> m;
+    m.set("aaa", 1);
+    m.set("aab", 2);
+    m.set("b", 3);
+    const char *keys[] = {"aaa", "aab", "aac", "b", "c", "a"};
+
+    art::thread_counters::reset();
+    for (const char *key : keys) {
+      m.get(key);
+    }
+    auto expected = art::thread_counters::read();
+
+    art::thread_counters::reset();
+    int values[6];
+    m.get_batch(keys, 6, values);
+    auto values_read = art::thread_counters::read();
+    REQUIRE_EQ(3, values_read[counter::get_hit]);
+    REQUIRE_EQ(3, values_read[counter::get_miss]);
+    REQUIRE_EQ(expected[counter::nodes_visited],
+               values_read[counter::nodes_visited]);
+  }
+
+  TEST_CASE("threads") {
+    art::thread_counters::reset();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([t]() {
+        art::art<int, art::thread_counters> m;
+        for (int i = 0; i < 1000; ++i) {
+          m.set((to_string(t) + "-" + to_string(i)).c_str(), i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    /* counters of exited threads are retained */
+    auto values = art::thread_counters::read();
+    REQUIRE_EQ(4, values[counter::set_root]);
+    REQUIRE_EQ(4000, values[counter::set_root] + values[counter::set_split] +
+                         values[counter::set_new_child]);
+  }
+}
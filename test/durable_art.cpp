@@ -0,0 +1,130 @@
+/**
+ * @file durable art tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+using std::map;
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+
+static string make_dir() {
+  char path[] = "/tmp/art_durable_XXXXXX";
+  REQUIRE(mkdtemp(path) != nullptr);
+  return path;
+}
+
+static void remove_dir(const string &dir) {
+  std::remove((dir + "/wal").c_str());
+  std::remove((dir + "/checkpoint").c_str());
+  std::remove((dir + "/checkpoint.tmp").c_str());
+  rmdir(dir.c_str());
+}
+
+static void require_equal(const art::art<int> &m, const map<string, int> &expected) {
+  auto expected_it = expected.begin();
+  for (auto it = m.begin(), it_end = m.end(); it != it_end; ++it) {
+    REQUIRE(expected_it != expected.end());
+    REQUIRE_EQ(expected_it->first, it.key());
+    REQUIRE_EQ(expected_it->second, *it);
+    ++expected_it;
+  }
+  REQUIRE(expected_it == expected.end());
+}
+
+TEST_SUITE("durable_art") {
+
+  TEST_CASE("recovery") {
+    string dir = make_dir();
+    map<string, int> expected;
+    mt19937_64 rng(0);
+
+    art::durable_art<int>::options opts;
+    opts.buffer_size = 256;
+    opts.group_commit_size = 100;
+
+    SUBCASE("log replay") {}
+    SUBCASE("checkpoints") { opts.checkpoint_size = 4096; }
+    SUBCASE("no fsync") { opts.sync_interval = 0; }
+
+    for (int round = 0; round < 3; ++round) {
+      art::durable_art<int> m(dir, opts);
+      require_equal(m.tree(), expected);
+      for (int i = 0; i < 1000; ++i) {
+        auto k = to_string(rng() % 500);
+        if (rng() % 4 == 0) {
+          m.del(k.c_str());
+          expected.erase(k);
+        } else {
+          m.set(k.c_str(), i + 1);
+          expected[k] = i + 1;
+        }
+      }
+      if (round == 1) {
+        m.checkpoint();
+      }
+    }
+
+    art::durable_art<int> m(dir, opts);
+    require_equal(m.tree(), expected);
+    remove_dir(dir);
+  }
+
+  TEST_CASE("torn log tail") {
+    string dir = make_dir();
+    {
+      art::durable_art<int> m(dir);
+      m.set("abc", 1);
+      m.set("abd", 2);
+      m.commit();
+    }
+
+    SUBCASE("garbage appended") {
+      std::ofstream out(dir + "/wal", std::ios::binary | std::ios::app);
+      /* complete header {len 7, crc 0} and payload, the crc does not match */
+      string record("\x07\x00\x00\x00\x00\x00\x00\x00garbage", 15);
+      out.write(record.data(), record.size());
+    }
+    SUBCASE("truncated record") {
+      std::ifstream in(dir + "/wal", std::ios::binary);
+      string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      in.close();
+      std::ofstream out(dir + "/wal", std::ios::binary | std::ios::trunc);
+      out.write(bytes.data(), bytes.size() - 3);
+    }
+
+    {
+      art::durable_art<int> m(dir);
+      REQUIRE_EQ(1, m.get("abc"));
+      m.set("abe", 3);
+    }
+    art::durable_art<int> m(dir);
+    REQUIRE_EQ(1, m.get("abc"));
+    REQUIRE_EQ(3, m.get("abe"));
+    remove_dir(dir);
+  }
+
+  TEST_CASE("oversized record") {
+    string dir = make_dir();
+    art::durable_art<int>::options opts;
+    opts.buffer_size = 64;
+    art::durable_art<int> m(dir, opts);
+    string k(100, 'x');
+    REQUIRE_THROWS_AS(m.set(k.c_str(), 1), std::length_error);
+    REQUIRE_EQ(0, m.get(k.c_str()));
+    m.set("abc", 1);
+    REQUIRE_EQ(1, m.get("abc"));
+    remove_dir(dir);
+  }
+}
@@ -0,0 +1,138 @@
+/**
+ * @file frozen art tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <map>
+#include <random>
+#include <string>
+
+using std::map;
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+
+TEST_SUITE("frozen_art") {
+
+  TEST_CASE("lookup and iteration") {
+    art::art<uint64_t> m;
+    map<string, uint64_t> expected;
+    mt19937_64 rng(0);
+    for (int i = 0; i < 10000; ++i) {
+      auto k = to_string(rng() % 1000000);
+      m.set(k.c_str(), i + 1);
+      expected[k] = i + 1;
+    }
+    /* dense node_256 and node_48 */
+    for (int i = 1; i < 128; ++i) {
+      auto k = string("dense") + (char)i;
+      m.set(k.c_str(), i);
+      expected[k] = i;
+    }
+    for (int i = 0; i < 30; ++i) {
+      auto k = string("medium") + (char)('A' + i);
+      m.set(k.c_str(), i + 1);
+      expected[k] = i + 1;
+    }
+
+    art::frozen_art<uint64_t> frozen = m.freeze();
+    REQUIRE_EQ(expected.size(), frozen.size());
+
+    SUBCASE("independent of the tree") {
+      m.set("dense", 42);
+      m.del("medium");
+      m.del("mediumA");
+      REQUIRE_EQ(0, frozen.get("dense"));
+      REQUIRE_EQ(1, frozen.get("mediumA"));
+    }
+
+    SUBCASE("get") {
+      for (const auto &entry : expected) {
+        REQUIRE_EQ(entry.second, frozen.get(entry.first.c_str()));
+      }
+      REQUIRE_EQ(0, frozen.get("missing"));
+      REQUIRE_EQ(0, frozen.get("dense"));
+      REQUIRE_EQ(0, frozen.get(""));
+    }
+
+    SUBCASE("full scan") {
+      auto expected_it = expected.begin();
+      for (auto it = frozen.begin(), it_end = frozen.end(); it != it_end; ++it) {
+        REQUIRE(expected_it != expected.end());
+        REQUIRE_EQ(expected_it->first, it.key());
+        REQUIRE_EQ(expected_it->second, *it);
+        ++expected_it;
+      }
+      REQUIRE(expected_it == expected.end());
+    }
+
+    SUBCASE("lower bound") {
+      for (int i = 0; i < 1000; ++i) {
+        auto k = to_string(rng() % 1000000);
+        auto expected_it = expected.lower_bound(k);
+        auto it = frozen.begin(k.c_str());
+        if (expected_it == expected.end()) {
+          REQUIRE(it == frozen.end());
+        } else {
+          REQUIRE(it != frozen.end());
+          REQUIRE_EQ(expected_it->first, it.key());
+        }
+      }
+      for (const char *k : {"", "0", "dense", "densf", "medium", "mediumB", "z"}) {
+        auto expected_it = expected.lower_bound(k);
+        auto it = frozen.begin(k);
+        if (expected_it == expected.end()) {
+          REQUIRE(it == frozen.end());
+        } else {
+          REQUIRE(it != frozen.end());
+          REQUIRE_EQ(expected_it->first, it.key());
+        }
+      }
+    }
+  }
+
+  TEST_CASE("node_256") {
+    art::art<int> m;
+    for (int i = -128; i < 128; ++i) {
+      char k[] = {'a', (char)i, 'b', 0};
+      if (i != 0) {
+        m.set(k, i);
+      }
+    }
+    m.set("a", 1000);
+    auto frozen = m.freeze();
+    for (int i = -128; i < 128; ++i) {
+      char k[] = {'a', (char)i, 'b', 0};
+      if (i != 0) {
+        REQUIRE_EQ(i, frozen.get(k));
+      }
+    }
+    REQUIRE_EQ(1000, frozen.get("a"));
+    /* partial keys are ordered as signed chars */
+    REQUIRE_EQ(-128, *frozen.begin());
+    char k[] = {'a', (char)-1, 'c', 0};
+    REQUIRE_EQ(1000, *frozen.begin(k));
+    k[1] = 1;
+    REQUIRE_EQ(2, *frozen.begin(k));
+  }
+
+  TEST_CASE("empty and single key") {
+    art::art<int> m;
+    auto empty = m.freeze();
+    REQUIRE_EQ(0, empty.size());
+    REQUIRE_EQ(0, empty.get("abc"));
+    REQUIRE(empty.begin() == empty.end());
+    REQUIRE(empty.begin("abc") == empty.end());
+
+    m.set("abc", 1);
+    auto single = m.freeze();
+    REQUIRE_EQ(1, single.size());
+    REQUIRE_EQ(1, single.get("abc"));
+    REQUIRE_EQ(0, single.get("ab"));
+    REQUIRE_EQ("abc", single.begin().key());
+    REQUIRE(single.begin("abc") != single.end());
+    REQUIRE(single.begin("abd") == single.end());
+  }
+}
@@ -0,0 +1,234 @@
+/**
+ * @file mapped art tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using std::map;
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+
+/* mapped_art expects an 8 byte aligned image */
+static std::vector<uint64_t> aligned_image(const string &bytes) {
+  std::vector<uint64_t> aligned(bytes.size() / 8 + 1);
+  std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char *>(aligned.data()));
+  return aligned;
+}
+
+TEST_SUITE("mapped_art") {
+
+  TEST_CASE("lookup and iteration") {
+    art::art<uint64_t> m;
+    map<string, uint64_t> expected;
+    mt19937_64 rng(0);
+    for (int i = 0; i < 10000; ++i) {
+      auto k = to_string(rng() % 1000000);
+      m.set(k.c_str(), i + 1);
+      expected[k] = i + 1;
+    }
+    /* dense node_256 and node_48 */
+    for (int i = 1; i < 128; ++i) {
+      auto k = string("dense") + (char)i;
+      m.set(k.c_str(), i);
+      expected[k] = i;
+    }
+    for (int i = 0; i < 30; ++i) {
+      auto k = string("medium") + (char)('A' + i);
+      m.set(k.c_str(), i + 1);
+      expected[k] = i + 1;
+    }
+
+    std::stringstream stream;
+    art::mapped_art<uint64_t>::write(m, stream);
+    string bytes = stream.str();
+    auto aligned = aligned_image(bytes);
+    art::mapped_art<uint64_t> image(reinterpret_cast<const char *>(aligned.data()),
+                                    bytes.size());
+
+    REQUIRE_EQ(expected.size(), image.size());
+
+    SUBCASE("get") {
+      for (const auto &entry : expected) {
+        REQUIRE_EQ(entry.second, image.get(entry.first.c_str()));
+      }
+      REQUIRE_EQ(0, image.get("missing"));
+      REQUIRE_EQ(0, image.get("dense"));
+      REQUIRE_EQ(0, image.get(""));
+    }
+
+    SUBCASE("full scan") {
+      auto expected_it = expected.begin();
+      for (auto it = image.begin(), it_end = image.end(); it != it_end; ++it) {
+        REQUIRE(expected_it != expected.end());
+        REQUIRE_EQ(expected_it->first, it.key());
+        REQUIRE_EQ(expected_it->second, *it);
+        ++expected_it;
+      }
+      REQUIRE(expected_it == expected.end());
+    }
+
+    SUBCASE("lower bound") {
+      for (int i = 0; i < 1000; ++i) {
+        auto k = to_string(rng() % 1000000);
+        auto expected_it = expected.lower_bound(k);
+        auto it = image.begin(k.c_str());
+        if (expected_it == expected.end()) {
+          REQUIRE(it == image.end());
+        } else {
+          REQUIRE(it != image.end());
+          REQUIRE_EQ(expected_it->first, it.key());
+        }
+      }
+      for (const char *k : {"", "0", "dense", "densf", "medium", "mediumB", "z"}) {
+        auto expected_it = expected.lower_bound(k);
+        auto it = image.begin(k);
+        if (expected_it == expected.end()) {
+          REQUIRE(it == image.end());
+        } else {
+          REQUIRE(it != image.end());
+          REQUIRE_EQ(expected_it->first, it.key());
+        }
+      }
+    }
+  }
+
+  TEST_CASE("node_8 is written as node_16") {
+    art::art<uint64_t, art::no_counters, art::hysteresis_shrink,
+             art::node_ladder<art::node_4, art::node_8, art::node_16,
+                              art::node_48, art::node_256>>
+        m;
+    map<string, uint64_t> expected;
+    for (int i = 0; i < 8; ++i) {
+      for (int j = 0; j <= i; ++j) {
+        auto k = string(1, (char)('a' + i)) + (char)('a' + j);
+        uint64_t v = expected.size() + 1;
+        m.set(k.c_str(), v);
+        expected[k] = v;
+      }
+    }
+    REQUIRE_GT(m.memory_stats()[art::node_type::node_8].count_, 0);
+
+    std::stringstream stream;
+    art::mapped_art<uint64_t>::write(m, stream);
+    string bytes = stream.str();
+    auto aligned = aligned_image(bytes);
+    art::mapped_art<uint64_t> image(reinterpret_cast<const char *>(aligned.data()),
+                                    bytes.size());
+    auto expected_it = expected.begin();
+    for (auto it = image.begin(), it_end = image.end(); it != it_end; ++it) {
+      REQUIRE(expected_it != expected.end());
+      REQUIRE_EQ(expected_it->first, it.key());
+      REQUIRE_EQ(expected_it->second, image.get(it.key().c_str()));
+      ++expected_it;
+    }
+    REQUIRE(expected_it == expected.end());
+  }
+
+  TEST_CASE("memory mapped file") {
+    art::art<int> m;
+    for (int i = 0; i < 1000; ++i) {
+      m.set(to_string(i).c_str(), i);
+    }
+
+    char path[] = "/tmp/art_mapped_XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    close(fd);
+    {
+      std::ofstream out(path, std::ios::binary);
+      art::mapped_art<int>::write(m, out);
+    }
+
+    {
+      art::mapped_art<int> image(path);
+      art::mapped_art<int> moved(std::move(image));
+      for (int i = 0; i < 1000; ++i) {
+        REQUIRE_EQ(i, moved.get(to_string(i).c_str()));
+      }
+      REQUIRE_EQ(1000, moved.size());
+    }
+
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << "not an image, but long enough to contain header and trailer";
+    }
+    REQUIRE_THROWS_AS(art::mapped_art<int>{path}, std::runtime_error);
+    std::remove(path);
+    REQUIRE_THROWS_AS(art::mapped_art<int>{path}, std::runtime_error);
+  }
+
+  TEST_CASE("corrupt offsets") {
+    art::art<int> m;
+    m.set("a", 1);
+    m.set("b", 2);
+    std::stringstream stream;
+    art::mapped_art<int>::write(m, stream);
+    string bytes = stream.str();
+    auto aligned = aligned_image(bytes);
+    char *image = reinterpret_cast<char *>(aligned.data());
+    /* trailer is {root, n_keys, magic, reserved} */
+    uint64_t *root = reinterpret_cast<uint64_t *>(image + bytes.size() - 24);
+
+    SUBCASE("child offset past the image") {
+      /* node_4 child offsets follow the 8 byte header and 8 partial keys */
+      uint64_t *child = reinterpret_cast<uint64_t *>(image + *root + 16);
+      *child = bytes.size() * 2;
+      art::mapped_art<int> corrupt(image, bytes.size());
+      REQUIRE_THROWS_AS(corrupt.get("a"), std::runtime_error);
+      REQUIRE_THROWS_AS(corrupt.begin(), std::runtime_error);
+    }
+
+    SUBCASE("child offset not preceding its parent") {
+      uint64_t *child = reinterpret_cast<uint64_t *>(image + *root + 16);
+      *child = *root;
+      art::mapped_art<int> corrupt(image, bytes.size());
+      REQUIRE_THROWS_AS(corrupt.get("a"), std::runtime_error);
+    }
+
+    SUBCASE("childless inner node") {
+      /* node_header is {type, reserved, prefix_len, n_children} */
+      uint32_t *n_children = reinterpret_cast<uint32_t *>(image + *root + 4);
+      *n_children = 0;
+      REQUIRE_THROWS_AS(art::mapped_art<int>(image, bytes.size()),
+                        std::runtime_error);
+      *n_children = 2;
+      uint64_t *children = reinterpret_cast<uint64_t *>(image + *root + 16);
+      children[0] = children[1] = 0;
+      art::mapped_art<int> corrupt(image, bytes.size());
+      REQUIRE_THROWS_AS(corrupt.begin(), std::runtime_error);
+    }
+
+    SUBCASE("root offset past the image") {
+      *root = bytes.size();
+      REQUIRE_THROWS_AS(art::mapped_art<int>(image, bytes.size()),
+                        std::runtime_error);
+    }
+  }
+
+  TEST_CASE("empty tree") {
+    art::art<int> m;
+    std::stringstream stream;
+    art::mapped_art<int>::write(m, stream);
+    string bytes = stream.str();
+    auto aligned = aligned_image(bytes);
+    art::mapped_art<int> image(reinterpret_cast<const char *>(aligned.data()),
+                               bytes.size());
+    REQUIRE_EQ(0, image.size());
+    REQUIRE_EQ(0, image.get("abc"));
+    REQUIRE(image.begin() == image.end());
+    REQUIRE(image.begin("abc") == image.end());
+  }
+}
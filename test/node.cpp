@@ -48,4 +48,45 @@ TEST_SUITE("node") {
     CHECK_EQ(0, node.check_prefix(key.c_str() + 8, key_len - 8));
     CHECK_EQ(0, node.check_prefix(key.c_str() + 9, key_len - 9));
   }
+
+  TEST_CASE("check_prefix long prefixes") {
+    /* lengths around the 8, 16 and 32 byte kernel widths */
+    mt19937 g(0);
+    std::vector<string> prefixes;
+    for (int prefix_len = 0; prefix_len < 100; ++prefix_len) {
+      string prefix(prefix_len, 'a');
+      for (char &c : prefix) {
+        c = 'a' + g() % 4;
+      }
+      prefixes.push_back(prefix);
+    }
+    leaf_node<int*> node(nullptr);
+
+    SUBCASE("mismatch at every position") {
+      for (string &prefix : prefixes) {
+        node.prefix_ = (char *) prefix.data();
+        node.prefix_len_ = prefix.length();
+        for (int i = 0; i < node.prefix_len_; ++i) {
+          string key = prefix;
+          key[i] = 'z';
+          CHECK_EQ(i, node.check_prefix(key.c_str(), key.length() + 1));
+        }
+      }
+    }
+
+    SUBCASE("bounded by the key length") {
+      for (string &prefix : prefixes) {
+        node.prefix_ = (char *) prefix.data();
+        node.prefix_len_ = prefix.length();
+        for (int key_len = 0; key_len <= node.prefix_len_; ++key_len) {
+          /* exactly key_len bytes, reading past them is a heap overflow */
+          std::unique_ptr<char[]> key(new char[key_len]);
+          std::copy(prefix.data(), prefix.data() + key_len, key.get());
+          CHECK_EQ(key_len, node.check_prefix(key.get(), key_len));
+        }
+      }
+    }
+
+    node.prefix_ = nullptr;
+  }
 }
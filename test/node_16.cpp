@@ -7,7 +7,9 @@
 #include "doctest.h"
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <random>
+#include <set>
 #include <vector>
 
 using namespace art;
@@ -237,6 +239,50 @@ TEST_SUITE("node 16") {
     }
   }
 
+  TEST_CASE("ordered children match a sorted reference") {
+    /* set up */
+    array<int, 256> partial_keys;
+    for (int i = 0; i < 256; i += 1) {
+      partial_keys[i] = i - 128;
+    }
+    leaf_node<void*> child(nullptr);
+    mt19937 g(0);
+
+    for (int experiment = 0; experiment < 200; experiment += 1) {
+      node_16<void*> node;
+      std::set<int> reference;
+
+      /* fill up, then delete half of the children in random order */
+      shuffle(partial_keys.begin(), partial_keys.end(), g);
+      for (int i = 0; i < 16; i += 1) {
+        node.set_child(partial_keys[i], &child);
+        reference.insert(partial_keys[i]);
+      }
+      shuffle(partial_keys.begin(), partial_keys.begin() + 16, g);
+      for (int i = 0; i < 8; i += 1) {
+        REQUIRE_EQ(&child, node.del_child(partial_keys[i]));
+        reference.erase(partial_keys[i]);
+      }
+      REQUIRE_EQ(8, node.n_children());
+
+      for (int pk = -128; pk < 128; pk += 1) {
+        auto successor = reference.lower_bound(pk);
+        if (successor == reference.end()) {
+          REQUIRE_THROWS_AS(node.next_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(*successor, node.next_partial_key(pk));
+        }
+        auto predecessor = reference.upper_bound(pk);
+        if (predecessor == reference.begin()) {
+          REQUIRE_THROWS_AS(node.prev_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(*std::prev(predecessor), node.prev_partial_key(pk));
+        }
+        REQUIRE_EQ(reference.count(pk) == 1, node.find_child(pk) != nullptr);
+      }
+    }
+  }
+
   TEST_CASE("grow to node_48 preserves offset (PR #20)") {
     // This test reproduces the bug reported in PR #20:
     // When node_16 grows to node_48, the indexes_ array must use 128 offset
@@ -320,5 +366,25 @@ TEST_SUITE("node 16") {
         delete dummy_children[i];
       }
     }
+
+    SUBCASE("negative partial keys after grow") {
+      leaf_node<void*>* dummy_children[16];
+      node_16<void*>* n16 = new node_16<void*>();
+      for (int i = 0; i < 16; ++i) {
+        dummy_children[i] = new leaf_node<void*>(nullptr);
+        n16->set_child(-128 + i, dummy_children[i]);
+      }
+      auto* n48 = static_cast<node_48<void*>*>(n16->grow());
+      for (int i = 0; i < 16; ++i) {
+        auto** child_ptr = n48->find_child(-128 + i);
+        REQUIRE(child_ptr != nullptr);
+        REQUIRE(*child_ptr == dummy_children[i]);
+      }
+      REQUIRE_EQ(-128, n48->next_partial_key(-128));
+      delete n48;
+      for (int i = 0; i < 16; ++i) {
+        delete dummy_children[i];
+      }
+    }
   }
 }
@@ -7,6 +7,8 @@
 #include "doctest.h"
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <map>
 #include <random>
 #include <vector>
 
@@ -252,4 +254,72 @@ TEST_SUITE("node 256") {
       REQUIRE_THROWS_AS(n.prev_partial_key(0), std::out_of_range);
     }
   }
+
+  TEST_CASE("churn matches a sorted reference") {
+    /* set up */
+    array<node<void*> *, 256> children;
+    for (int i = 0; i < 256; i += 1) {
+      children[i] = new leaf_node<void*>(nullptr);
+    }
+    mt19937 g(0);
+    node_256<void*> *subject = new node_256<void*>();
+    std::map<int, node<void*> *> reference;
+
+    for (int step = 0; step < 4000; step += 1) {
+      /* insert or delete a random partial key */
+      int partial_key = static_cast<int>(g() % 256) - 128;
+      if (reference.count(partial_key) == 1) {
+        REQUIRE_EQ(reference[partial_key], subject->del_child(partial_key));
+        reference.erase(partial_key);
+      } else {
+        subject->set_child(partial_key, children[128 + partial_key]);
+        reference[partial_key] = children[128 + partial_key];
+      }
+      REQUIRE_EQ(static_cast<int>(reference.size()), subject->n_children());
+
+      if (step % 200 != 0) {
+        continue;
+      }
+      for (int pk = -128; pk < 128; pk += 1) {
+        auto successor = reference.lower_bound(pk);
+        if (successor == reference.end()) {
+          REQUIRE_THROWS_AS(subject->next_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(successor->first, subject->next_partial_key(pk));
+        }
+        auto predecessor = reference.upper_bound(pk);
+        if (predecessor == reference.begin()) {
+          REQUIRE_THROWS_AS(subject->prev_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(std::prev(predecessor)->first,
+                     subject->prev_partial_key(pk));
+        }
+      }
+      /* child iteration visits the children in order */
+      auto expected = reference.begin();
+      for (auto it = subject->begin(); it != subject->end(); ++it, ++expected) {
+        REQUIRE(expected != reference.end());
+        REQUIRE_EQ(expected->first, *it);
+      }
+      REQUIRE(expected == reference.end());
+    }
+
+    /* shrink carries over every child */
+    while (reference.size() > 48) {
+      subject->del_child(reference.begin()->first);
+      reference.erase(reference.begin());
+    }
+    inner_node<void*> *shrunk = subject->shrink();
+    REQUIRE_EQ(node_type::node_48, shrunk->type());
+    REQUIRE_EQ(48, shrunk->n_children());
+    for (auto &entry : reference) {
+      REQUIRE_EQ(entry.second, *shrunk->find_child(entry.first));
+    }
+    delete shrunk;
+
+    /* tear down */
+    for (int i = 0; i < 256; i += 1) {
+      delete children[i];
+    }
+  }
 }
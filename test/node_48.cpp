@@ -7,6 +7,8 @@
 #include "doctest.h"
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <map>
 #include <random>
 #include <vector>
 
@@ -235,4 +237,70 @@ TEST_SUITE("node 48") {
       REQUIRE_THROWS_AS(n.prev_partial_key(0), std::out_of_range);
     }
   }
+
+  TEST_CASE("churn matches a sorted reference") {
+    /* set up */
+    array<node<void*> *, 256> children;
+    for (int i = 0; i < 256; i += 1) {
+      children[i] = new leaf_node<void*>(nullptr);
+    }
+    mt19937 g(0);
+    node_48<void*> *subject = new node_48<void*>();
+    std::map<int, node<void*> *> reference;
+
+    for (int step = 0; step < 2000; step += 1) {
+      /* insert or delete a random partial key, reusing freed slots */
+      int partial_key = static_cast<int>(g() % 256) - 128;
+      if (reference.count(partial_key) == 1) {
+        REQUIRE_EQ(reference[partial_key], subject->del_child(partial_key));
+        reference.erase(partial_key);
+      } else if (!subject->is_full()) {
+        subject->set_child(partial_key, children[128 + partial_key]);
+        reference[partial_key] = children[128 + partial_key];
+      }
+      REQUIRE_EQ(static_cast<int>(reference.size()), subject->n_children());
+
+      if (step % 100 != 0) {
+        continue;
+      }
+      for (int pk = -128; pk < 128; pk += 1) {
+        auto successor = reference.lower_bound(pk);
+        if (successor == reference.end()) {
+          REQUIRE_THROWS_AS(subject->next_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(successor->first, subject->next_partial_key(pk));
+        }
+        auto predecessor = reference.upper_bound(pk);
+        if (predecessor == reference.begin()) {
+          REQUIRE_THROWS_AS(subject->prev_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(std::prev(predecessor)->first, subject->prev_partial_key(pk));
+        }
+        auto child = subject->find_child(pk);
+        if (reference.count(pk) == 1) {
+          REQUIRE(child != nullptr);
+          REQUIRE_EQ(reference[pk], *child);
+        } else {
+          REQUIRE(child == nullptr);
+        }
+      }
+    }
+
+    /* grow and shrink carry over every child */
+    inner_node<void*> *grown = subject->grow();
+    for (auto &entry : reference) {
+      REQUIRE_EQ(entry.second, *grown->find_child(entry.first));
+    }
+    inner_node<void*> *shrunk = grown->shrink();
+    REQUIRE_EQ(node_type::node_48, shrunk->type());
+    for (auto &entry : reference) {
+      REQUIRE_EQ(entry.second, *shrunk->find_child(entry.first));
+    }
+    delete shrunk;
+
+    /* tear down */
+    for (int i = 0; i < 256; i += 1) {
+      delete children[i];
+    }
+  }
 }
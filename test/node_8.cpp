@@ -0,0 +1,183 @@
+/**
+ * @file node_8 tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
+#include <set>
+
+using namespace art;
+
+using std::array;
+using std::mt19937;
+using std::random_device;
+using std::shuffle;
+
+TEST_SUITE("node 8") {
+
+  TEST_CASE("monte carlo") {
+    /* set up */
+    array<uint8_t, 256> partial_keys;
+    array<node<void*> *, 256> children;
+
+    for (int i = 0; i < 256; i += 1) {
+      /* populate partial_keys with all values in the partial_keys_t domain */
+      partial_keys[i] = i;
+
+      /* populate child nodes */
+      children[i] = new leaf_node<void*>(nullptr);
+    }
+
+    /* rng */
+    random_device rd;
+    mt19937 g(rd());
+
+    for (int experiment = 0; experiment < 1000; experiment += 1) {
+      /* test subject */
+      node_8<void*> subject;
+
+      /* shuffle in order to make a seemingly random insertion order */
+      shuffle(partial_keys.begin(), partial_keys.end(), g);
+      for (int i = 0; i < 8; i += 1) {
+        REQUIRE_FALSE(subject.is_full());
+
+        auto partial_key = partial_keys[i];
+        auto child = children[partial_key];
+        subject.set_child(partial_key, child);
+
+        for (int j = 0; j <= i; j += 1) {
+          auto p_k = partial_keys[j];
+          auto actual_child_ptr = subject.find_child(p_k);
+          REQUIRE(actual_child_ptr != nullptr);
+          REQUIRE_EQ(children[p_k], *actual_child_ptr);
+        }
+      }
+      REQUIRE(subject.is_full());
+    }
+
+    /* tear down */
+    for (int i = 0; i < 256; i += 1) {
+      delete children[i];
+    }
+  }
+
+  TEST_CASE("delete child") {
+    leaf_node<void*> n1(nullptr);
+    leaf_node<void*> n2(nullptr);
+    leaf_node<void*> n4(nullptr);
+    leaf_node<void*> n5(nullptr);
+
+    node_8<void*> subject;
+
+    subject.set_child(1, &n1);
+    subject.set_child(2, &n2);
+    subject.set_child(4, &n4);
+    subject.set_child(5, &n5);
+
+    SUBCASE("delete child that doesn't exist (3)") {
+      REQUIRE(subject.del_child(3) == nullptr);
+      REQUIRE_EQ(4, subject.n_children());
+    }
+
+    SUBCASE("delete min (1)") {
+      REQUIRE(subject.del_child(1) == &n1);
+      REQUIRE(subject.find_child(1) == nullptr);
+      REQUIRE(*subject.find_child(2) == &n2);
+      REQUIRE(*subject.find_child(4) == &n4);
+      REQUIRE(*subject.find_child(5) == &n5);
+    }
+
+    SUBCASE("delete inner (4)") {
+      REQUIRE(subject.del_child(4) == &n4);
+      REQUIRE(*subject.find_child(1) == &n1);
+      REQUIRE(*subject.find_child(2) == &n2);
+      REQUIRE(subject.find_child(4) == nullptr);
+      REQUIRE(*subject.find_child(5) == &n5);
+    }
+
+    SUBCASE("delete max (5)") {
+      REQUIRE(subject.del_child(5) == &n5);
+      REQUIRE(*subject.find_child(1) == &n1);
+      REQUIRE(*subject.find_child(2) == &n2);
+      REQUIRE(*subject.find_child(4) == &n4);
+      REQUIRE(subject.find_child(5) == nullptr);
+    }
+  }
+
+  TEST_CASE("ordered children match a sorted reference") {
+    /* set up */
+    array<int, 256> partial_keys;
+    for (int i = 0; i < 256; i += 1) {
+      partial_keys[i] = i - 128;
+    }
+    leaf_node<void*> child(nullptr);
+    mt19937 g(0);
+
+    for (int experiment = 0; experiment < 200; experiment += 1) {
+      node_8<void*> subject;
+      std::set<int> reference;
+
+      /* fill up, then delete some of the children in random order */
+      shuffle(partial_keys.begin(), partial_keys.end(), g);
+      for (int i = 0; i < 8; i += 1) {
+        subject.set_child(partial_keys[i], &child);
+        reference.insert(partial_keys[i]);
+      }
+      shuffle(partial_keys.begin(), partial_keys.begin() + 8, g);
+      for (int i = 0; i < 3; i += 1) {
+        REQUIRE_EQ(&child, subject.del_child(partial_keys[i]));
+        reference.erase(partial_keys[i]);
+      }
+      REQUIRE_EQ(5, subject.n_children());
+
+      for (int pk = -128; pk < 128; pk += 1) {
+        auto successor = reference.lower_bound(pk);
+        if (successor == reference.end()) {
+          REQUIRE_THROWS_AS(subject.next_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(*successor, subject.next_partial_key(pk));
+        }
+        auto predecessor = reference.upper_bound(pk);
+        if (predecessor == reference.begin()) {
+          REQUIRE_THROWS_AS(subject.prev_partial_key(pk), std::out_of_range);
+        } else {
+          REQUIRE_EQ(*std::prev(predecessor), subject.prev_partial_key(pk));
+        }
+        REQUIRE_EQ(reference.count(pk) == 1,
+                   subject.find_child(pk) != nullptr);
+      }
+    }
+  }
+
+  TEST_CASE("grow to node_16 and shrink to node_4") {
+    leaf_node<void*> child(nullptr);
+    auto n8 = new node_8<void*>();
+    for (int i = 0; i < 8; ++i) {
+      n8->set_child(-128 + 32 * i, &child);
+    }
+    REQUIRE(n8->is_full());
+
+    inner_node<void*> *grown = n8->grow();
+    REQUIRE(grown->type() == node_type::node_16);
+    REQUIRE_EQ(8, grown->n_children());
+    for (int i = 0; i < 8; ++i) {
+      REQUIRE(*grown->find_child(-128 + 32 * i) == &child);
+    }
+    delete grown;
+
+    n8 = new node_8<void*>();
+    for (int i = 0; i < 4; ++i) {
+      n8->set_child(100 - i, &child);
+    }
+    inner_node<void*> *shrunk = n8->shrink();
+    REQUIRE(shrunk->type() == node_type::node_4);
+    REQUIRE_EQ(97, shrunk->next_partial_key(0));
+    REQUIRE_EQ(100, shrunk->prev_partial_key(127));
+    delete shrunk;
+  }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file simd tests
+ * @author Rafael Kallis <rk@rafaelkallis.com>
+ */
+
+#include "art.hpp"
+#include "doctest.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace art;
+
+/**
+ * Checks a common_prefix_len kernel against the byte by byte definition. The
+ * inputs are heap blocks of exactly len bytes, so reads past len are caught
+ * by sanitizers.
+ */
+template <class Kernel> static void check_kernel(Kernel kernel) {
+  std::mt19937 g(0);
+  for (int len = 0; len <= 200; len += 1) {
+    std::vector<char> a(len), b;
+    for (char &c : a) {
+      c = static_cast<char>(g());
+    }
+    for (int mismatch = 0; mismatch <= len; mismatch += 1) {
+      b = a;
+      if (mismatch < len) {
+        b[mismatch] ^= 1 + g() % 255;
+      }
+      REQUIRE_EQ(mismatch, kernel(a.data(), b.data(), len));
+    }
+  }
+}
+
+TEST_SUITE("simd") {
+
+  TEST_CASE("common prefix length") {
+    SUBCASE("baseline") { check_kernel(detail::common_prefix_len_baseline); }
+
+    SUBCASE("dispatched") { check_kernel(common_prefix_len); }
+
+#if defined(ART_CPU_DISPATCH)
+    SUBCASE("avx2") {
+      if (detect_cpu_features().avx2_) {
+        check_kernel(detail::common_prefix_len_avx2);
+      }
+    }
+
+    SUBCASE("avx512") {
+      if (detect_cpu_features().avx512bw_) {
+        check_kernel(detail::common_prefix_len_avx512);
+      }
+    }
+#endif
+  }
+
+  TEST_CASE("bitmap scans") {
+    uint64_t bitmap[4] = {0, 0, 0, 0};
+
+    SUBCASE("empty bitmap") {
+      for (int i = 0; i < 256; i += 1) {
+        REQUIRE_EQ(-1, bitmap_next(bitmap, i));
+        REQUIRE_EQ(-1, bitmap_prev(bitmap, i));
+      }
+    }
+
+    SUBCASE("bits across words") {
+      const int bits[] = {0, 63, 64, 130, 255};
+      for (int bit : bits) {
+        bitmap[bit >> 6] |= 1ull << (bit & 63);
+      }
+      for (int i = 0; i < 256; i += 1) {
+        int next = -1, prev = -1;
+        for (int bit : bits) {
+          if (bit >= i && next == -1) {
+            next = bit;
+          }
+          if (bit <= i) {
+            prev = bit;
+          }
+        }
+        REQUIRE_EQ(next, bitmap_next(bitmap, i));
+        REQUIRE_EQ(prev, bitmap_prev(bitmap, i));
+      }
+    }
+  }
+}
@@ -241,6 +241,21 @@ TEST_SUITE("tree_it") {
       REQUIRE(it == it_end);
     }
 
+    SUBCASE("key greater than all children") {
+      int int0 = 0;
+      int int1 = 1;
+      art::art<int*> m;
+      m.set("aab", &int0);
+      m.set("ab", &int1);
+
+      /* greater than the children of (a) and of (a)'s child (a) */
+      REQUIRE(m.begin("b") == m.end());
+      REQUIRE(m.begin("abb") == m.end());
+      auto it = m.begin("aac");
+      REQUIRE(it != m.end());
+      REQUIRE_EQ(&int1, *it);
+    }
+
     SUBCASE("monte carlo") {
       mt19937_64 rng(0);
       int n_bytes = 4;
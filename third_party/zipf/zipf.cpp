@@ -60,3 +60,79 @@ uint32_t fast_zipf::binary_search_in_cdf(double key) {
   return lo;
 }
 
+
+/* log1p(x) / x, accurate near 0 */
+static double helper1(double x) {
+  return std::abs(x) > 1e-8 ? std::log1p(x) / x
+                            : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+/* expm1(x) / x, accurate near 0 */
+static double helper2(double x) {
+  return std::abs(x) > 1e-8 ? std::expm1(x) / x
+                            : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+rejection_inversion_zipf::rejection_inversion_zipf(uint64_t size, double skew,
+                                                   uint64_t seed)
+    : size_(size), skew_(skew), rng_(seed), uniform_(0.0, 1.0) {
+  h_integral_x1_ = h_integral(1.5) - 1;
+  h_integral_size_ = h_integral(size_ + 0.5);
+  s_ = 2 - h_integral_inverse(h_integral(2.5) - h(2));
+}
+
+uint64_t rejection_inversion_zipf::operator()() {
+  while (true) {
+    double u = h_integral_size_ +
+               uniform_(rng_) * (h_integral_x1_ - h_integral_size_);
+    double x = h_integral_inverse(u);
+    double k = std::floor(x + 0.5);
+    if (k < 1) {
+      k = 1;
+    } else if (k > size_) {
+      k = size_;
+    }
+    if (k - x <= s_ || u >= h_integral(k + 0.5) - h(k)) {
+      return static_cast<uint64_t>(k) - 1;
+    }
+  }
+}
+
+double rejection_inversion_zipf::h(double x) const {
+  return std::exp(-skew_ * std::log(x));
+}
+
+double rejection_inversion_zipf::h_integral(double x) const {
+  double log_x = std::log(x);
+  return helper2((1 - skew_) * log_x) * log_x;
+}
+
+double rejection_inversion_zipf::h_integral_inverse(double x) const {
+  double t = x * (1 - skew_);
+  if (t < -1) {
+    t = -1;
+  }
+  return std::exp(helper1(t) * x);
+}
+
+scrambled_zipf::scrambled_zipf(uint64_t size, double skew, uint64_t seed)
+    : zipf_(size, skew, seed), size_(size) {
+  unsigned bits = 1;
+  while (bits < 64 && (uint64_t(1) << bits) < size_) {
+    ++bits;
+  }
+  mask_ = bits < 64 ? (uint64_t(1) << bits) - 1 : ~uint64_t(0);
+  shift_ = (bits + 1) / 2;
+}
+
+uint64_t scrambled_zipf::operator()() { return permute(zipf_()); }
+
+uint64_t scrambled_zipf::permute(uint64_t rank) const {
+  /* bijection on [0, mask_], cycle-walked until it lands in [0, size_) */
+  do {
+    rank = (rank * 0x9e3779b97f4a7c15ull) & mask_;
+    rank ^= rank >> shift_;
+    rank = (rank * 0xbf58476d1ce4e5b9ull) & mask_;
+  } while (rank >= size_);
+  return rank;
+}
@@ -36,4 +36,50 @@ private:
   uint32_t binary_search_in_cdf(double key);
 };
 
+/**
+ * Zipf sampler using rejection-inversion (Hoermann and Derflinger, 1996),
+ * O(1) memory and expected O(1) time per sample for any size.
+ * Returns ranks in [0, size), rank 0 being the most frequent.
+ * Instances are independent, use one per thread.
+ */
+class rejection_inversion_zipf {
+public:
+  explicit rejection_inversion_zipf(uint64_t size, double skew = 1.0,
+                                    uint64_t seed = 0);
+
+  uint64_t operator()();
+
+private:
+  const uint64_t size_;
+  const double skew_;
+  double h_integral_x1_;
+  double h_integral_size_;
+  double s_;
+  std::mt19937_64 rng_;
+  std::uniform_real_distribution<double> uniform_;
+
+  double h(double x) const;
+  double h_integral(double x) const;
+  double h_integral_inverse(double x) const;
+};
+
+/**
+ * Zipf sampler whose ranks are permuted over [0, size), so that the most
+ * frequent values are scattered instead of clustered at the lowest ranks.
+ */
+class scrambled_zipf {
+public:
+  explicit scrambled_zipf(uint64_t size, double skew = 1.0, uint64_t seed = 0);
+
+  uint64_t operator()();
+
+private:
+  rejection_inversion_zipf zipf_;
+  const uint64_t size_;
+  uint64_t mask_;
+  unsigned shift_;
+
+  uint64_t permute(uint64_t rank) const;
+};
+
 #endif